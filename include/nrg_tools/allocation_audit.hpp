@@ -0,0 +1,206 @@
+#pragma once
+
+/**
+ * Optional detection of heap allocations in code that must not allocate (e.g. a realtime control loop).
+ * Compiled out entirely unless NRG_TOOLS_ENABLE_ALLOCATION_AUDIT is defined before including nrg_tools.
+ *
+ * When enabled, code inside NRG_NO_ALLOCATION_SCOPE("name") is guarded: every allocation made by the
+ * thread while the scope is open is counted, and reported on stderr with the scope name and a backtrace.
+ * Allocations are only seen if exactly one source file of the executable also defines
+ * NRG_TOOLS_DEFINE_ALLOCATION_HOOKS, which replaces malloc and friends with counting versions (glibc only).
+ * Link with -rdynamic to get function names in the backtraces.
+ */
+
+#ifdef NRG_TOOLS_ENABLE_ALLOCATION_AUDIT
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <execinfo.h>
+#include <malloc.h>
+#include <unistd.h>
+
+#define NRG_ALLOCATION_CONCAT_INNER(a, b) a##b
+#define NRG_ALLOCATION_CONCAT(a, b) NRG_ALLOCATION_CONCAT_INNER(a, b)
+
+/**
+ * Reports every allocation made by this thread in the rest of the enclosing scope, under the given name (a string literal)
+ */
+#define NRG_NO_ALLOCATION_SCOPE(name) \
+	nrg_tools::allocation_audit::NoAllocationScope NRG_ALLOCATION_CONCAT(nrg_no_allocation_scope_, __LINE__)(name)
+
+namespace nrg_tools{
+namespace allocation_audit{
+
+	const int kMaxStackDepth = 32;
+
+	/**
+	 * The audit state of one thread. Plain data, so it can be used from inside malloc
+	 */
+	struct ThreadState
+	{
+		const char* scope;			// The innermost open scope, NULL if none
+		bool print_stack;
+		bool in_hook;				// Set while reporting, since printing a backtrace may allocate itself
+		uint64_t violations;
+	};
+
+	inline ThreadState& threadState()
+	{
+		static thread_local ThreadState state = {NULL, true, false, 0};
+		return state;
+	}
+
+	/**
+	 * The number of allocations made inside scopes, by all threads
+	 */
+	inline std::atomic<uint64_t>& totalViolations()
+	{
+		static std::atomic<uint64_t> violations(0);
+		return violations;
+	}
+
+	inline void writeString(const char* str)
+	{
+		if(write(STDERR_FILENO, str, strlen(str)) < 0) return;
+	}
+
+	/**
+	 * Called by the allocation hooks for every allocation
+	 * @param bytes		The size of the allocation
+	 */
+	inline void onAllocation(size_t bytes)
+	{
+		ThreadState& state = threadState();
+		if(state.scope == NULL || state.in_hook) return;
+		state.in_hook = true;
+		++state.violations;
+		totalViolations().fetch_add(1, std::memory_order_relaxed);
+
+		if(state.print_stack)
+		{
+			// Output that does not allocate, since the heap may be in any state
+			char line[256];
+			snprintf(line, sizeof(line), "[nrg_tools] %zu byte allocation in no-allocation scope \"%s\":\n", bytes, state.scope);
+			writeString(line);
+			void* stack[kMaxStackDepth];
+			const int depth = backtrace(stack, kMaxStackDepth);
+			backtrace_symbols_fd(stack, depth, STDERR_FILENO);
+		}
+		state.in_hook = false;
+	}
+
+	/**
+	 * Loads the unwinder ahead of time, since the first backtrace() call allocates
+	 */
+	inline bool primeBacktrace()
+	{
+		void* stack[2];
+		return backtrace(stack, 2) > 0;
+	}
+
+	/**
+	 * \class NoAllocationScope
+	 * Guards the thread from its construction to its destruction. Use NRG_NO_ALLOCATION_SCOPE
+	 * in code that is meant to stay in, and this class directly to check code from a test
+	 */
+	class NoAllocationScope
+	{
+	public:
+		/**
+		 * Constructor
+		 * @param name			The name reported with allocations. Must outlive the scope (e.g. a string literal)
+		 * @param print_stack	If 'false', allocations are only counted
+		 */
+		NoAllocationScope(const char* name, bool print_stack=true)
+		{
+			static const bool primed = primeBacktrace();
+			(void)primed;
+			ThreadState& state = threadState();
+			previous_scope_ = state.scope;
+			previous_print_stack_ = state.print_stack;
+			start_violations_ = state.violations;
+			state.scope = name;
+			state.print_stack = print_stack;
+		}
+
+		~NoAllocationScope()
+		{
+			ThreadState& state = threadState();
+			state.scope = previous_scope_;
+			state.print_stack = previous_print_stack_;
+		}
+
+		/**
+		 * Gets the number of allocations so far in this scope
+		 * @return		The number of allocations
+		 */
+		uint64_t getViolations() const {return threadState().violations - start_violations_;};
+
+	private:
+		const char* previous_scope_;
+		bool previous_print_stack_;
+		uint64_t start_violations_;
+	};
+
+} // end allocation_audit namespace
+} // end nrg_tools namespace
+
+#ifdef NRG_TOOLS_DEFINE_ALLOCATION_HOOKS
+// Replacements for the C allocation functions. operator new, the standard containers
+// and Eigen all allocate through these, so one set of hooks covers every source.
+// The glibc declarations are included first, so the exception specifications match
+extern "C" {
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t num, size_t size);
+	void* __libc_realloc(void* ptr, size_t size);
+	void* __libc_memalign(size_t alignment, size_t size);
+
+	void* malloc(size_t size) __THROW
+	{
+		nrg_tools::allocation_audit::onAllocation(size);
+		return __libc_malloc(size);
+	}
+
+	void* calloc(size_t num, size_t size) __THROW
+	{
+		nrg_tools::allocation_audit::onAllocation(num * size);
+		return __libc_calloc(num, size);
+	}
+
+	void* realloc(void* ptr, size_t size) __THROW
+	{
+		nrg_tools::allocation_audit::onAllocation(size);
+		return __libc_realloc(ptr, size);
+	}
+
+	void* memalign(size_t alignment, size_t size) __THROW
+	{
+		nrg_tools::allocation_audit::onAllocation(size);
+		return __libc_memalign(alignment, size);
+	}
+
+	void* aligned_alloc(size_t alignment, size_t size) __THROW
+	{
+		nrg_tools::allocation_audit::onAllocation(size);
+		return __libc_memalign(alignment, size);
+	}
+
+	int posix_memalign(void** ptr, size_t alignment, size_t size) __THROW
+	{
+		nrg_tools::allocation_audit::onAllocation(size);
+		*ptr = __libc_memalign(alignment, size);
+		return *ptr == NULL ? ENOMEM : 0;
+	}
+}
+#endif
+
+#else
+
+#define NRG_NO_ALLOCATION_SCOPE(name)
+
+#endif
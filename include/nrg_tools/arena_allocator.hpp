@@ -0,0 +1,155 @@
+#pragma once
+
+/**
+ * Memory for the temporary vectors of conversions and controller tools, taken from a buffer
+ * owned by the caller instead of the global heap
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace nrg_tools{
+
+	/**
+	 * \class MonotonicArena
+	 * A fixed buffer that hands out memory by moving a pointer forward. Memory is never freed one piece
+	 * at a time; instead the whole arena is reset at once, e.g. at the start of every control cycle.
+	 * Give each thread its own arena, so threads never contend on an allocator.
+	 * If the buffer runs out, memory comes from the heap until the next reset, and is counted as an overflow
+	 */
+	class MonotonicArena
+	{
+	public:
+		/**
+		 * Constructor. The only heap allocation the arena makes in normal use
+		 * @param capacity		The size of the buffer, in bytes
+		 */
+		explicit MonotonicArena(size_t capacity);
+
+		/**
+		 * Constructor for an arena on memory owned by the caller (e.g. a buffer on the stack). Makes no heap allocation
+		 * @param buffer		The memory to hand out. Must outlive the arena
+		 * @param capacity		The size of the buffer, in bytes
+		 */
+		MonotonicArena(void* buffer, size_t capacity);
+
+		~MonotonicArena();
+
+		/**
+		 * Gets memory from the arena
+		 * @param bytes			The size of the memory
+		 * @param alignment		The alignment of the memory, a power of 2
+		 * @return 				The memory, valid until the next reset
+		 */
+		void* allocate(size_t bytes, size_t alignment);
+
+		/**
+		 * Makes all of the arena's memory available again. Anything allocated from it must no longer be used
+		 */
+		void reset();
+
+		/**
+		 * Gets the number of bytes handed out since the last reset, including alignment padding
+		 * @return		The bytes used
+		 */
+		size_t getUsed() const {return used_;};
+
+		/**
+		 * Gets the size of the buffer
+		 * @return		The capacity in bytes
+		 */
+		size_t getCapacity() const {return capacity_;};
+
+		/**
+		 * Gets the number of allocations that did not fit in the buffer, since the arena was made.
+		 * If this is not 0, the capacity should be increased
+		 * @return		The number of overflows
+		 */
+		size_t getOverflows() const {return overflows_;};
+
+	private:
+		std::vector<unsigned char> owned_buffer_;
+		unsigned char* buffer_;
+		size_t capacity_;
+		size_t used_ = 0;
+		size_t overflows_ = 0;
+		std::vector<void*> overflow_blocks_;
+
+		// Not copyable, since allocators point to it
+		MonotonicArena(const MonotonicArena&);
+		MonotonicArena& operator=(const MonotonicArena&);
+	};
+
+	/**
+	 * \class ArenaAllocator
+	 * A standard allocator that takes its memory from a MonotonicArena, for use with standard containers
+	 * and the conversion functions (e.g. nrg_conversions::toVec(msg, ArenaAllocator<double>(arena)))
+	 */
+	template <class T>
+	class ArenaAllocator
+	{
+	public:
+		typedef T value_type;
+
+		explicit ArenaAllocator(MonotonicArena& arena) : arena_(&arena) {};
+		template <class U> ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.getArena()) {};
+
+		T* allocate(size_t n) {return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));};
+		void deallocate(T*, size_t) {};
+
+		MonotonicArena* getArena() const {return arena_;};
+
+	private:
+		MonotonicArena* arena_;
+	};
+
+	template <class T, class U> bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {return a.getArena() == b.getArena();}
+	template <class T, class U> bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {return a.getArena() != b.getArena();}
+
+	/**
+	 * A std::vector<double> whose memory comes from a MonotonicArena
+	 */
+	typedef std::vector<double, ArenaAllocator<double> > ArenaVector;
+
+	inline MonotonicArena::MonotonicArena(size_t capacity) : owned_buffer_(capacity), buffer_(owned_buffer_.data()), capacity_(capacity)
+	{
+	}
+
+	inline MonotonicArena::MonotonicArena(void* buffer, size_t capacity) : buffer_(static_cast<unsigned char*>(buffer)), capacity_(capacity)
+	{
+	}
+
+	inline MonotonicArena::~MonotonicArena()
+	{
+		reset();
+	}
+
+	inline void* MonotonicArena::allocate(size_t bytes, size_t alignment)
+	{
+		const uintptr_t start = reinterpret_cast<uintptr_t>(buffer_) + used_;
+		const size_t padding = (alignment - start % alignment) % alignment;
+		if(used_ + padding + bytes <= capacity_)
+		{
+			used_ += padding + bytes;
+			return reinterpret_cast<void*>(start + padding);
+		}
+
+		++overflows_;
+		overflow_blocks_.push_back(::operator new(bytes));
+		return overflow_blocks_.back();
+	}
+
+	inline void MonotonicArena::reset()
+	{
+		used_ = 0;
+		for(size_t i=0; i<overflow_blocks_.size(); ++i)
+		{
+			::operator delete(overflow_blocks_[i]);
+		}
+		overflow_blocks_.clear();
+	}
+
+} // end nrg_tools namespace
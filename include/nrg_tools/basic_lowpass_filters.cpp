@@ -1,6 +1,7 @@
 #pragma once
 
 #include <basic_lowpass_filters.h>
+#include <profiling.hpp>
 using namespace nrg_tools;
 
 BasicLowPassFilter::BasicLowPassFilter(double filter_coefficient, double init_value)
@@ -34,6 +35,20 @@ void BasicLowPassFilter::reset(const double reset_value)
 	previous_filtered_measurement_ = reset_value;	
 }
 
+void BasicLowPassFilter::getState(double* state) const
+{
+	state[0] = previous_measurements_[0];
+	state[1] = previous_measurements_[1];
+	state[2] = previous_filtered_measurement_;
+}
+
+void BasicLowPassFilter::setState(const double* state)
+{
+	previous_measurements_[0] = state[0];
+	previous_measurements_[1] = state[1];
+	previous_filtered_measurement_ = state[2];
+}
+
 // ~~~~~~~~~~~~~ Multi Filter ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 BasicLowPassMultiFilter::BasicLowPassMultiFilter(std::vector<double> filter_coefficients, std::vector<double> init_values)
 {
@@ -46,6 +61,7 @@ BasicLowPassMultiFilter::BasicLowPassMultiFilter(std::vector<double> filter_coef
 
 std::vector<double> BasicLowPassMultiFilter::filter(const std::vector<double>& new_measurements)
 {
+	NRG_PROFILE_SCOPE("BasicLowPassMultiFilter::filter");
 	if(new_measurements.size() != num_filters_)
 	{
 		throw std::out_of_range("New Measurement vector must be same size as the number of filters");
@@ -58,6 +74,20 @@ std::vector<double> BasicLowPassMultiFilter::filter(const std::vector<double>& n
 	return output;
 }
 
+void BasicLowPassMultiFilter::filterBatch(double* measurements, const size_t num_measurements)
+{
+	NRG_PROFILE_SCOPE("BasicLowPassMultiFilter::filterBatch");
+	// One filter at a time, so its state stays in registers for the whole batch
+	for(size_t i = 0; i<num_filters_; ++i)
+	{
+		for(size_t n = 0; n<num_measurements; ++n)
+		{
+			double& value = measurements[n*num_filters_ + i];
+			value = filters_[i].filter(value);
+		}
+	}
+}
+
 void BasicLowPassMultiFilter::reset(const std::vector<double>& reset_values)
 {
 	if(reset_values.size() != num_filters_)
@@ -77,4 +107,35 @@ void BasicLowPassMultiFilter::reset(const int index, const double reset_value)
 		throw std::out_of_range("Given index is higher than the number of filters");
 	}
 	filters_[index].reset(reset_value);
+}
+
+void BasicLowPassMultiFilter::getState(double* state) const
+{
+	for(size_t i = 0; i<num_filters_; ++i)
+	{
+		filters_[i].getState(state + i*BasicLowPassFilter::STATE_SIZE);
+	}
+}
+
+void BasicLowPassMultiFilter::getState(std::vector<double>& state) const
+{
+	state.resize(getStateSize());
+	if(!state.empty()) getState(state.data());
+}
+
+void BasicLowPassMultiFilter::setState(const double* state)
+{
+	for(size_t i = 0; i<num_filters_; ++i)
+	{
+		filters_[i].setState(state + i*BasicLowPassFilter::STATE_SIZE);
+	}
+}
+
+void BasicLowPassMultiFilter::setState(const std::vector<double>& state)
+{
+	if(state.size() != getStateSize())
+	{
+		throw std::out_of_range("State vector must have STATE_SIZE values per filter");
+	}
+	if(!state.empty()) setState(state.data());
 }
\ No newline at end of file
@@ -28,6 +28,23 @@ namespace nrg_tools{
 		 */
 		void reset(const double reset_value);
 
+		/**
+		 * The number of values in the internal state of the filter
+		 */
+		static const size_t STATE_SIZE = 3;
+
+		/**
+		 * Copies the internal state of the filter: the last 2 measurements, then the last filtered value
+		 * @param state		Filled with STATE_SIZE values
+		 */
+		void getState(double* state) const;
+
+		/**
+		 * Sets the internal state of the filter, e.g. from getState() before a restart
+		 * @param state		STATE_SIZE values, in the order of getState()
+		 */
+		void setState(const double* state);
+
 	private:
 		double previous_measurements_[2] = {0.0, 0.0};
 		double previous_filtered_measurement_ = 0.0;
@@ -57,6 +74,14 @@ namespace nrg_tools{
 		 */
 		std::vector<double> filter(const std::vector<double>& new_measurements);
 
+		/**
+		 * Updates the filters with several measurements in a row, in place
+		 * @param measurements		The measurements, oldest first, with getNumberFilters() values each back to back.
+		 *							Replaced with the filtered data
+		 * @param num_measurements	The number of measurements
+		 */
+		void filterBatch(double* measurements, const size_t num_measurements);
+
 		/**
 		 * Sets all of the filters to the desired values
 		 * @param reset_values	The values to set the filters to
@@ -77,6 +102,37 @@ namespace nrg_tools{
 		 */
 		size_t getNumberFilters(){return num_filters_;};
 
+		/**
+		 * Gets the number of values in the internal state of all the filters
+		 * @return		BasicLowPassFilter::STATE_SIZE values per filter
+		 */
+		size_t getStateSize() const {return num_filters_ * BasicLowPassFilter::STATE_SIZE;};
+
+		/**
+		 * Copies the internal state of every filter, one filter after the other
+		 * @param state		Filled with getStateSize() values
+		 */
+		void getState(double* state) const;
+
+		/**
+		 * Copies the internal state of every filter, one filter after the other
+		 * @param state		The state. Resized to getStateSize() values if needed
+		 */
+		void getState(std::vector<double>& state) const;
+
+		/**
+		 * Sets the internal state of every filter, e.g. from getState() before a restart,
+		 * so filtering continues without settling from a reset value
+		 * @param state		getStateSize() values, in the order of getState()
+		 */
+		void setState(const double* state);
+
+		/**
+		 * Sets the internal state of every filter. Throws an error if the size does not match
+		 * @param state		getStateSize() values, in the order of getState()
+		 */
+		void setState(const std::vector<double>& state);
+
 	private:
 		size_t num_filters_ = 0;
 		std::vector<BasicLowPassFilter> filters_;
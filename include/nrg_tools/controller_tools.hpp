@@ -5,6 +5,8 @@
  */
 
 #include "conversions.hpp"
+#include <algorithm>
+#include <stdexcept>
 
 namespace nrg_tools{
 
@@ -27,14 +29,15 @@ namespace nrg_tools{
 	 * @param input		The input object to bound, must have valid conversion functions
 	 * @param lower 	The lower limits, element-wise on the input
 	 * @param upper 	The upper limits, element-wise on the input
+	 * @param alloc 	The allocator of the temporary vectors (e.g. nrg_tools::ArenaAllocator<double>(arena))
 	 * @return 			The bounded object, of same type as the input
 	 */
-	template <class T, class U> T boundAll (const T& input, const U& lower, const U& upper)
+	template <class T, class U, class Alloc> T boundAll (const T& input, const U& lower, const U& upper, const Alloc& alloc)
 	{
-		std::vector<double> input_vector, upper_vector, lower_vector, output_vector;
-		convert(input, input_vector);
-		convert(lower, lower_vector);
-		convert(upper, upper_vector);
+		NRG_PROFILE_SCOPE("boundAll");
+		std::vector<double, Alloc> input_vector = nrg_conversions::toVec(input, alloc);
+		const std::vector<double, Alloc> lower_vector = nrg_conversions::toVec(lower, alloc);
+		const std::vector<double, Alloc> upper_vector = nrg_conversions::toVec(upper, alloc);
 		if(input_vector.size() != lower_vector.size() 
 			|| input_vector.size() != upper_vector.size())
 		{
@@ -43,10 +46,56 @@ namespace nrg_tools{
 		}
 		for(size_t i=0; i<input_vector.size(); ++i)
 		{
-			output_vector.push_back(bound(input_vector[i], lower_vector[i], upper_vector[i]));
+			input_vector[i] = bound(input_vector[i], lower_vector[i], upper_vector[i]);
+		}
+		// Start from the input so fields that are not bounded (e.g. headers) are kept
+		T output = input;
+		nrg_conversions::fromVec(input_vector, output);
+		return output;
+	}
+
+	/**
+	 * Restricts an array/message/etc to the given bounds. The bounds are
+	 * allowed to be a different type as long as they have the same
+	 * number of elements
+	 * @param input		The input object to bound, must have valid conversion functions
+	 * @param lower 	The lower limits, element-wise on the input
+	 * @param upper 	The upper limits, element-wise on the input
+	 * @return 			The bounded object, of same type as the input
+	 */
+	template <class T, class U> T boundAll (const T& input, const U& lower, const U& upper)
+	{
+		return boundAll(input, lower, upper, std::allocator<double>());
+	}
+
+	/**
+	 * Restricts only some fields of a message to the given bounds, e.g. boundFields<fields::Force>(wrench, lower, upper).
+	 * The other fields are kept, and the bounds only have the selected values
+	 * @param input		The input object to bound, must have valid conversion functions
+	 * @param lower 	The lower limits, element-wise on the selected fields
+	 * @param upper 	The upper limits, element-wise on the selected fields
+	 * @return 			The bounded object, of same type as the input
+	 */
+	template <class Selection, class T, class U> T boundFields (const T& input, const U& lower, const U& upper)
+	{
+		NRG_PROFILE_SCOPE("boundFields");
+		alignas(double) unsigned char buffer[32 * sizeof(double)];
+		MonotonicArena arena(buffer, sizeof(buffer));
+		const ArenaAllocator<double> alloc(arena);
+		Eigen::Matrix<double, Selection::size, 1> selected;
+		const ArenaVector lower_vector = nrg_conversions::toVec(lower, alloc);
+		const ArenaVector upper_vector = nrg_conversions::toVec(upper, alloc);
+		if(!extractFields<Selection>(input, selected) || static_cast<size_t>(selected.size()) != lower_vector.size()
+			|| static_cast<size_t>(selected.size()) != upper_vector.size())
+		{
+			throw std::invalid_argument("Selected fields and bound sizes do not match");
 		}
-		T output;
-		nrg_conversions::fromVec(output_vector, output);
+		for(Eigen::Index i=0; i<selected.size(); ++i)
+		{
+			selected[i] = bound(selected[i], lower_vector[i], upper_vector[i]);
+		}
+		T output = input;
+		writeFields<Selection>(selected, output);
 		return output;
 	}
 
@@ -54,16 +103,18 @@ namespace nrg_tools{
 	 * Restricts an array/message/etc to the given bounds by uniformly scaling
 	 * the object until all elements are within bounds. The bounds are
 	 * allowed to be a different type as long as they have the same number of elements.
-	 * Because it scales the array, the limits considered to be symmetric around 0
+	 * Because it scales the array, the limits considered to be symmetric around 0.
+	 * For other limits, or limits that couple elements, see ConstraintProjector
 	 * @param input		The input object to bound, must have valid conversion functions
 	 * @param limit 	The (plus and minus) limit, element-wise on the input
+	 * @param alloc 	The allocator of the temporary vectors (e.g. nrg_tools::ArenaAllocator<double>(arena))
 	 * @return 			The bounded object, of same type as the input
 	 */
-	template <class T, class U> T boundUniform (const T& input, const U& limit)
+	template <class T, class U, class Alloc> T boundUniform (const T& input, const U& limit, const Alloc& alloc)
 	{
-		Eigen::VectorXd input_vector, limit_vector;
-		convert(input, input_vector);
-		convert(limit, limit_vector);
+		NRG_PROFILE_SCOPE("boundUniform");
+		std::vector<double, Alloc> input_vector = nrg_conversions::toVec(input, alloc);
+		const std::vector<double, Alloc> limit_vector = nrg_conversions::toVec(limit, alloc);
 		if(input_vector.size() != limit_vector.size())
 		{
 			throw std::invalid_argument("Input and limit sizes do not match");
@@ -72,16 +123,627 @@ namespace nrg_tools{
 		double min_multiplier = 1;
 		for(size_t i=0; i<input_vector.size(); ++i)
 		{
-			if(fabs(input_vector(i)) > fabs(limit_vector(i)))
+			if(fabs(input_vector[i]) > fabs(limit_vector[i]))
 			{
 				// We need to scale the input down
-				min_multiplier = std::min(min_multiplier, (fabs(limit_vector(i))/fabs(input_vector(i))));
+				min_multiplier = std::min(min_multiplier, (fabs(limit_vector[i])/fabs(input_vector[i])));
 			}
 		}
-		input_vector *= min_multiplier;
-		T output;
-		convert(input_vector, output);
+		for(size_t i=0; i<input_vector.size(); ++i)
+		{
+			input_vector[i] *= min_multiplier;
+		}
+		T output = input;
+		nrg_conversions::fromVec(input_vector, output);
+		return output;
+	}
+
+	/**
+	 * Restricts an array/message/etc to the given bounds by uniformly scaling
+	 * the object until all elements are within bounds. The bounds are
+	 * allowed to be a different type as long as they have the same number of elements.
+	 * Because it scales the array, the limits considered to be symmetric around 0
+	 * @param input		The input object to bound, must have valid conversion functions
+	 * @param limit 	The (plus and minus) limit, element-wise on the input
+	 * @return 			The bounded object, of same type as the input
+	 */
+	template <class T, class U> T boundUniform (const T& input, const U& limit)
+	{
+		return boundUniform(input, limit, std::allocator<double>());
+	}
+
+	/**
+	 * \class ConstraintProjector
+	 * Limits commands (e.g. joint velocities) to a fixed set of constraints that all contain zero: bounds on each
+	 * element, bounds on linear combinations of the elements (e.g. lower <= A * qdot <= upper), and limits on weighted
+	 * norms (e.g. ||J_linear * qdot|| <= Cartesian speed). Every constraint is stacked into one matrix when the
+	 * projector is compiled, so each projection costs a fixed number of small matrix products.
+	 * UNIFORM_SCALING scales the whole command down until it fits, keeping its direction. boundUniform is the
+	 * special case of symmetric bounds on each element.
+	 * NEAREST finds the command that fits closest to the input (in a weighted distance) with a fixed number of ADMM
+	 * iterations, which only solve with a factorization cached at compile time. The iterations start from the previous
+	 * solution, and the result is uniformly scaled at the end so it always fits, even if it has not fully converged
+	 */
+	class ConstraintProjector
+	{
+	public:
+		/**
+		 * UNIFORM_SCALING:	Scale the command down until it fits
+		 * NEAREST: 		Move the command to the closest point that fits, in the distance set by setMetric()
+		 */
+		enum Method {UNIFORM_SCALING, NEAREST};
+
+		/**
+		 * Constructor
+		 * @param dimension		The number of elements in a command
+		 * @param method		How commands are moved inside the constraints
+		 * @param iterations	The number of ADMM iterations for NEAREST
+		 * @param penalty		The ADMM penalty for NEAREST. Higher = converges faster when many constraints are active,
+		 *						but slower when few are. Around the metric weights works well
+		 */
+		ConstraintProjector(size_t dimension, Method method=UNIFORM_SCALING, int iterations=20, double penalty=1.0);
+
+		/**
+		 * Adds bounds on each element of the command
+		 * @param lower		The lower limits. Must be <= 0
+		 * @param upper		The upper limits. Must be >= 0
+		 */
+		void addBounds(const Eigen::VectorXd& lower, const Eigen::VectorXd& upper);
+
+		/**
+		 * Adds symmetric bounds on each element of the command
+		 * @param limit		The (plus and minus) limit of each element
+		 */
+		void addBounds(const Eigen::VectorXd& limit) {addBounds(-limit.cwiseAbs(), limit.cwiseAbs());};
+
+		/**
+		 * Adds bounds on linear combinations of the command, lower <= rows * command <= upper
+		 * @param rows		The combinations, one row per constraint
+		 * @param lower		The lower limits. Must be <= 0
+		 * @param upper		The upper limits. Must be >= 0
+		 */
+		void addLinear(const Eigen::MatrixXd& rows, const Eigen::VectorXd& lower, const Eigen::VectorXd& upper);
+
+		/**
+		 * Adds a limit on a weighted norm of the command, ||weights * command|| <= limit
+		 * @param weights	The weights (e.g. the linear rows of a Jacobian)
+		 * @param limit		The largest allowed norm. Must be >= 0
+		 */
+		void addNorm(const Eigen::MatrixXd& weights, double limit);
+
+		/**
+		 * Sets the weight of each element in the distance minimized by NEAREST. All ones by default
+		 * @param weights	The weights, all positive. Elements with higher weights are moved less
+		 */
+		void setMetric(const Eigen::VectorXd& weights);
+
+		/**
+		 * Stacks the constraints and caches the factorization. Called by the first projection otherwise,
+		 * so call it outside of the control loop. Adding constraints afterwards requires compiling again
+		 */
+		void compile();
+
+		/**
+		 * Moves a command inside the constraints
+		 * @param input		The command
+		 * @param output	The limited command. May be the same vector as the input
+		 * @return 			'true' if the command had to be limited, 'false' if it already fit
+		 */
+		bool project(const Eigen::Ref<const Eigen::VectorXd>& input, Eigen::Ref<Eigen::VectorXd> output);
+
+		/**
+		 * Moves a command inside the constraints
+		 * @param input		The command, must have valid conversion functions
+		 * @return 			The limited command, of same type as the input
+		 */
+		template <class T> T project(const T& input);
+
+		/**
+		 * Forgets the previous solution, so the next NEAREST projection starts from scratch
+		 */
+		void reset() {warm_ = false;};
+
+		size_t getDimension() const {return dimension_;};
+		size_t getNumberConstraints() const {return bounded_rows_.rows() + norm_rows_.rows();};
+
+	private:
+		struct NormGroup
+		{
+			Eigen::Index start;
+			Eigen::Index size;
+			double limit;
+		};
+
+		size_t dimension_;
+		Method method_;
+		int iterations_;
+		double penalty_;
+		bool compiled_ = false;
+		bool warm_ = false;
+		Eigen::MatrixXd bounded_rows_, norm_rows_;
+		Eigen::VectorXd lower_, upper_, metric_;
+		std::vector<NormGroup> norms_;
+
+		// Cached at compile time. Every row is normalized, so the constraints are equally well conditioned
+		Eigen::MatrixXd rows_;
+		Eigen::VectorXd row_lower_, row_upper_;
+		std::vector<NormGroup> row_norms_;
+		Eigen::LLT<Eigen::MatrixXd> factorization_;
+		Eigen::VectorXd weighted_input_, constrained_, split_, dual_, solution_, input_vector_;
+
+		/**
+		 * Finds the largest scale (at most 1) that brings constrained values inside the stacked constraints
+		 */
+		double fitScale(const Eigen::VectorXd& values) const;
+
+		/**
+		 * Moves constrained values to the closest point inside the stacked constraints
+		 */
+		void clamp(Eigen::VectorXd& values) const;
+	};
+
+	inline ConstraintProjector::ConstraintProjector(size_t dimension, Method method, int iterations, double penalty)
+		: dimension_(dimension), method_(method), iterations_(iterations), penalty_(penalty)
+	{
+		if(dimension_ == 0 || iterations_ < 0 || penalty_ <= 0)
+		{
+			throw std::invalid_argument("Dimension and penalty must be positive, and iterations not negative");
+		}
+		bounded_rows_.resize(0, dimension_);
+		norm_rows_.resize(0, dimension_);
+		metric_ = Eigen::VectorXd::Ones(dimension_);
+	}
+
+	inline void ConstraintProjector::addBounds(const Eigen::VectorXd& lower, const Eigen::VectorXd& upper)
+	{
+		addLinear(Eigen::MatrixXd::Identity(dimension_, dimension_), lower, upper);
+	}
+
+	inline void ConstraintProjector::addLinear(const Eigen::MatrixXd& rows, const Eigen::VectorXd& lower, const Eigen::VectorXd& upper)
+	{
+		if(rows.cols() != static_cast<Eigen::Index>(dimension_) || lower.size() != rows.rows() || upper.size() != rows.rows())
+		{
+			throw std::invalid_argument("Constraint sizes do not match");
+		}
+		if((lower.array() > 0).any() || (upper.array() < 0).any())
+		{
+			throw std::invalid_argument("Constraints must allow a zero command");
+		}
+		const Eigen::Index start = bounded_rows_.rows();
+		bounded_rows_.conservativeResize(start + rows.rows(), Eigen::NoChange);
+		bounded_rows_.bottomRows(rows.rows()) = rows;
+		lower_.conservativeResize(start + rows.rows());
+		lower_.tail(rows.rows()) = lower;
+		upper_.conservativeResize(start + rows.rows());
+		upper_.tail(rows.rows()) = upper;
+		compiled_ = false;
+	}
+
+	inline void ConstraintProjector::addNorm(const Eigen::MatrixXd& weights, double limit)
+	{
+		if(weights.cols() != static_cast<Eigen::Index>(dimension_) || weights.rows() == 0 || limit < 0)
+		{
+			throw std::invalid_argument("Norm weights must have a column per element, and the limit must not be negative");
+		}
+		NormGroup group = {norm_rows_.rows(), weights.rows(), limit};
+		norm_rows_.conservativeResize(group.start + group.size, Eigen::NoChange);
+		norm_rows_.bottomRows(group.size) = weights;
+		norms_.push_back(group);
+		compiled_ = false;
+	}
+
+	inline void ConstraintProjector::setMetric(const Eigen::VectorXd& weights)
+	{
+		if(weights.size() != static_cast<Eigen::Index>(dimension_) || (weights.array() <= 0).any())
+		{
+			throw std::invalid_argument("Metric must have a positive weight per element");
+		}
+		metric_ = weights;
+		compiled_ = false;
+	}
+
+	inline void ConstraintProjector::compile()
+	{
+		const Eigen::Index num_bounded = bounded_rows_.rows(), num_rows = num_bounded + norm_rows_.rows();
+		rows_.resize(num_rows, dimension_);
+		row_lower_.resize(num_bounded);
+		row_upper_.resize(num_bounded);
+		for(Eigen::Index i=0; i<num_bounded; ++i)
+		{
+			const double norm = bounded_rows_.row(i).norm();
+			const double scale = (norm > 0) ? 1.0 / norm : 1.0;
+			rows_.row(i) = scale * bounded_rows_.row(i);
+			row_lower_[i] = scale * lower_[i];
+			row_upper_[i] = scale * upper_[i];
+		}
+		row_norms_ = norms_;
+		for(size_t i=0; i<norms_.size(); ++i)
+		{
+			// Scaling a whole group keeps it the same norm constraint
+			const double norm = norm_rows_.middleRows(norms_[i].start, norms_[i].size).rowwise().norm().maxCoeff();
+			const double scale = (norm > 0) ? 1.0 / norm : 1.0;
+			row_norms_[i].start += num_bounded;
+			row_norms_[i].limit *= scale;
+			rows_.middleRows(row_norms_[i].start, norms_[i].size) = scale * norm_rows_.middleRows(norms_[i].start, norms_[i].size);
+		}
+
+		// The ADMM command update always solves with the same matrix
+		Eigen::MatrixXd system = penalty_ * rows_.transpose() * rows_;
+		system.diagonal() += metric_;
+		factorization_.compute(system);
+
+		weighted_input_.setZero(dimension_);
+		solution_.setZero(dimension_);
+		constrained_.setZero(num_rows);
+		split_.setZero(num_rows);
+		dual_.setZero(num_rows);
+		warm_ = false;
+		compiled_ = true;
+	}
+
+	inline double ConstraintProjector::fitScale(const Eigen::VectorXd& values) const
+	{
+		double scale = 1;
+		for(Eigen::Index i=0; i<row_lower_.size(); ++i)
+		{
+			if(values[i] > row_upper_[i]) scale = std::min(scale, row_upper_[i] / values[i]);
+			else if(values[i] < row_lower_[i]) scale = std::min(scale, row_lower_[i] / values[i]);
+		}
+		for(size_t i=0; i<row_norms_.size(); ++i)
+		{
+			const double norm = values.segment(row_norms_[i].start, row_norms_[i].size).norm();
+			if(norm > row_norms_[i].limit) scale = std::min(scale, row_norms_[i].limit / norm);
+		}
+		return scale;
+	}
+
+	inline void ConstraintProjector::clamp(Eigen::VectorXd& values) const
+	{
+		const Eigen::Index num_bounded = row_lower_.size();
+		values.head(num_bounded) = values.head(num_bounded).cwiseMax(row_lower_).cwiseMin(row_upper_);
+		for(size_t i=0; i<row_norms_.size(); ++i)
+		{
+			const double norm = values.segment(row_norms_[i].start, row_norms_[i].size).norm();
+			if(norm > row_norms_[i].limit) values.segment(row_norms_[i].start, row_norms_[i].size) *= row_norms_[i].limit / norm;
+		}
+	}
+
+	inline bool ConstraintProjector::project(const Eigen::Ref<const Eigen::VectorXd>& input, Eigen::Ref<Eigen::VectorXd> output)
+	{
+		NRG_PROFILE_SCOPE("ConstraintProjector::project");
+		if(input.size() != static_cast<Eigen::Index>(dimension_) || output.size() != input.size())
+		{
+			throw std::invalid_argument("Command size does not match the constraints");
+		}
+		if(!compiled_)
+		{
+			compile();
+		}
+
+		constrained_.noalias() = rows_ * input;
+		const double scale = fitScale(constrained_);
+		if(scale >= 1)
+		{
+			// Already inside, and the closest point to the input is itself
+			output = input;
+			return false;
+		}
+		if(method_ == UNIFORM_SCALING)
+		{
+			output = scale * input;
+			return true;
+		}
+
+		if(!warm_)
+		{
+			split_ = scale * constrained_;
+			dual_.setZero();
+			warm_ = true;
+		}
+		weighted_input_ = metric_.cwiseProduct(input);
+		solution_ = input;
+		for(int iteration=0; iteration<iterations_; ++iteration)
+		{
+			// The command minimizing 1/2 |x - input|^2 + penalty/2 |rows * x - split + dual|^2
+			constrained_ = split_ - dual_;
+			solution_.noalias() = rows_.transpose() * constrained_;
+			solution_ = penalty_ * solution_ + weighted_input_;
+			factorization_.solveInPlace(solution_);
+
+			// Then the closest split variable inside the constraints, and the dual update
+			constrained_.noalias() = rows_ * solution_;
+			split_ = constrained_ + dual_;
+			clamp(split_);
+			dual_ += constrained_ - split_;
+		}
+
+		// Whatever the iterations reached, make sure it fits
+		constrained_.noalias() = rows_ * solution_;
+		output = fitScale(constrained_) * solution_;
+		return true;
+	}
+
+	template <class T>
+	T ConstraintProjector::project(const T& input)
+	{
+		convert(input, input_vector_);
+		project(input_vector_, input_vector_);
+		T output = input;
+		convert(input_vector_, output);
 		return output;
 	}
 
+	/**
+	 * \class TrajectoryInterpolator
+	 * Interpolates a list of timed waypoints (e.g. Poses converted with convert) so they can be resampled
+	 * at the controller rate. The polynomial of every segment is computed once when the interpolator is made.
+	 * Each evaluation then costs one polynomial per channel, computed on whole columns of channels at a time.
+	 * Query times are expected to mostly increase, so the segment of each query is found by stepping forward
+	 * from the last one, falling back to a binary search otherwise
+	 */
+	class TrajectoryInterpolator
+	{
+	public:
+		/**
+		 * LINEAR: 	Straight lines between waypoints
+		 * CUBIC: 	Natural cubic spline, with continuous velocity and acceleration
+		 * QUINTIC: Quintic spline through velocities and accelerations estimated from the neighbouring waypoints,
+		 *			with continuous velocity and acceleration
+		 */
+		enum Type {LINEAR, CUBIC, QUINTIC};
+
+		/**
+		 * Constructor
+		 * @param times				The time of each waypoint, strictly increasing
+		 * @param waypoints			The waypoints, one column per waypoint and one row per channel
+		 * @param type				The interpolation between waypoints
+		 * @param quaternion_rows	The first row of each quaternion (x, y, z, w) in the waypoints (e.g. {3} for Poses).
+		 *							These rows are slerped instead, at the same fraction of the segment as LINEAR
+		 */
+		TrajectoryInterpolator(const Eigen::VectorXd& times, const Eigen::MatrixXd& waypoints, Type type=CUBIC,
+							   const std::vector<int>& quaternion_rows=std::vector<int>());
+
+		/**
+		 * Evaluates the trajectory at many times. Times outside of the waypoint times are clamped to them
+		 * @param query_times	The times to evaluate, ideally increasing
+		 * @param output		The trajectory, one column per query time. Resized if needed
+		 */
+		void evaluate(const Eigen::VectorXd& query_times, Eigen::MatrixXd& output) const;
+
+		/**
+		 * Evaluates the trajectory at evenly spaced times, from the first waypoint to the last
+		 * @param period	The time between samples
+		 * @param output	The trajectory, one column per sample. Resized if needed
+		 */
+		void resample(const double period, Eigen::MatrixXd& output) const;
+
+		double getStartTime() const {return times_(0);};
+		double getEndTime() const {return times_(times_.size() - 1);};
+		size_t getNumberChannels() const {return waypoints_.rows();};
+
+	private:
+		Eigen::VectorXd times_;
+		Eigen::MatrixXd waypoints_;
+		std::vector<Eigen::MatrixXd> coefficients_;		// Polynomial coefficient of each power, one column per segment
+		std::vector<int> quaternion_rows_;
+
+		/**
+		 * Finds the segment containing time t, starting from the segment of the previous query
+		 */
+		size_t findSegment(const double t, size_t segment) const;
+	};
+
+	inline TrajectoryInterpolator::TrajectoryInterpolator(const Eigen::VectorXd& times, const Eigen::MatrixXd& waypoints, Type type,
+														  const std::vector<int>& quaternion_rows)
+	 : times_(times), waypoints_(waypoints), quaternion_rows_(quaternion_rows)
+	{
+		const int num_points = times_.size();
+		if(num_points == 0 || waypoints_.cols() != num_points)
+		{
+			throw std::invalid_argument("There must be one time for each waypoint");
+		}
+		for(int i=1; i<num_points; ++i)
+		{
+			if(times_(i) <= times_(i-1)) throw std::invalid_argument("Waypoint times must be strictly increasing");
+		}
+		for(size_t q=0; q<quaternion_rows_.size(); ++q)
+		{
+			const int row = quaternion_rows_[q];
+			if(row < 0 || row + 4 > waypoints_.rows()) throw std::out_of_range("Quaternion rows are outside of the waypoints");
+
+			// Normalize, and keep each quaternion in the hemisphere of the one before so slerp takes the short way
+			for(int i=0; i<num_points; ++i)
+			{
+				waypoints_.col(i).segment(row, 4).normalize();
+				if(i > 0 && waypoints_.col(i).segment(row, 4).dot(waypoints_.col(i-1).segment(row, 4)) < 0)
+				{
+					waypoints_.col(i).segment(row, 4) *= -1;
+				}
+			}
+		}
+
+		// A single waypoint is a constant
+		const int num_segments = std::max(num_points - 1, 1);
+		const int channels = waypoints_.rows();
+		const Eigen::MatrixXd& y = waypoints_;
+		Eigen::VectorXd h = Eigen::VectorXd::Ones(num_segments);
+		Eigen::MatrixXd slope = Eigen::MatrixXd::Zero(channels, num_segments);
+		for(int i=0; i<num_points-1; ++i)
+		{
+			h(i) = times_(i+1) - times_(i);
+			slope.col(i) = (y.col(i+1) - y.col(i)) / h(i);
+		}
+		if(num_points == 1) type = LINEAR;
+
+		if(type == LINEAR)
+		{
+			coefficients_.resize(2);
+			coefficients_[0] = y.leftCols(num_segments);
+			coefficients_[1] = slope;
+		}
+		else if(type == CUBIC)
+		{
+			// Second derivatives at the waypoints (0 at the ends), from the tridiagonal system solved for all channels at once
+			Eigen::MatrixXd m = Eigen::MatrixXd::Zero(channels, num_points);
+			Eigen::VectorXd diagonal(num_points);
+			Eigen::MatrixXd rhs = Eigen::MatrixXd::Zero(channels, num_points);
+			for(int i=1; i<num_points-1; ++i)
+			{
+				diagonal(i) = 2 * (h(i-1) + h(i));
+				rhs.col(i) = 6 * (slope.col(i) - slope.col(i-1));
+			}
+			for(int i=2; i<num_points-1; ++i)
+			{
+				const double factor = h(i-1) / diagonal(i-1);
+				diagonal(i) -= factor * h(i-1);
+				rhs.col(i) -= factor * rhs.col(i-1);
+			}
+			for(int i=num_points-2; i>=1; --i)
+			{
+				m.col(i) = (rhs.col(i) - h(i) * m.col(i+1)) / diagonal(i);
+			}
+
+			coefficients_.resize(4);
+			coefficients_[0] = y.leftCols(num_segments);
+			coefficients_[1].resize(channels, num_segments);
+			coefficients_[2].resize(channels, num_segments);
+			coefficients_[3].resize(channels, num_segments);
+			for(int i=0; i<num_segments; ++i)
+			{
+				coefficients_[1].col(i) = slope.col(i) - h(i) * (2 * m.col(i) + m.col(i+1)) / 6;
+				coefficients_[2].col(i) = m.col(i) / 2;
+				coefficients_[3].col(i) = (m.col(i+1) - m.col(i)) / (6 * h(i));
+			}
+		}
+		else
+		{
+			// Velocities and accelerations from the neighbouring waypoints. The ends keep the slope of their segment
+			Eigen::MatrixXd v(channels, num_points), a = Eigen::MatrixXd::Zero(channels, num_points);
+			v.col(0) = slope.col(0);
+			v.col(num_points-1) = slope.col(num_segments-1);
+			for(int i=1; i<num_points-1; ++i)
+			{
+				v.col(i) = (slope.col(i) * h(i-1) + slope.col(i-1) * h(i)) / (h(i-1) + h(i));
+				a.col(i) = 2 * (slope.col(i) - slope.col(i-1)) / (h(i-1) + h(i));
+			}
+
+			coefficients_.resize(6);
+			coefficients_[0] = y.leftCols(num_segments);
+			coefficients_[1] = v.leftCols(num_segments);
+			coefficients_[2] = a.leftCols(num_segments) / 2;
+			for(int k=3; k<6; ++k) coefficients_[k].resize(channels, num_segments);
+			for(int i=0; i<num_segments; ++i)
+			{
+				const double h1 = h(i), h2 = h1*h1, h3 = h2*h1;
+				const Eigen::VectorXd dp = y.col(i+1) - y.col(i);
+				coefficients_[3].col(i) = (20*dp - (8*v.col(i+1) + 12*v.col(i))*h1 - (3*a.col(i) - a.col(i+1))*h2) / (2*h3);
+				coefficients_[4].col(i) = (-30*dp + (14*v.col(i+1) + 16*v.col(i))*h1 + (3*a.col(i) - 2*a.col(i+1))*h2) / (2*h3*h1);
+				coefficients_[5].col(i) = (12*dp - 6*(v.col(i+1) + v.col(i))*h1 - (a.col(i) - a.col(i+1))*h2) / (2*h3*h2);
+			}
+		}
+	}
+
+	inline size_t TrajectoryInterpolator::findSegment(const double t, size_t segment) const
+	{
+		const size_t last_segment = coefficients_[0].cols() - 1;
+		if(t < times_(segment))
+		{
+			segment = 0;
+		}
+		for(int step=0; step<4; ++step)
+		{
+			if(segment == last_segment || t < times_(segment + 1)) return segment;
+			++segment;
+		}
+		// Far ahead: binary search the rest
+		const double* start = times_.data() + segment;
+		const double* end = times_.data() + last_segment + 1;
+		return std::max<size_t>(segment, std::upper_bound(start, end, t) - times_.data() - 1);
+	}
+
+	inline void TrajectoryInterpolator::evaluate(const Eigen::VectorXd& query_times, Eigen::MatrixXd& output) const
+	{
+		NRG_PROFILE_SCOPE("TrajectoryInterpolator::evaluate");
+		output.resize(waypoints_.rows(), query_times.size());
+		const int order = coefficients_.size() - 1;
+		const bool single_point = (times_.size() == 1);
+		size_t segment = 0;
+		for(int q=0; q<query_times.size(); ++q)
+		{
+			const double t = bound(query_times(q), getStartTime(), getEndTime());
+			segment = findSegment(t, segment);
+			const double tau = t - times_(segment);
+
+			// Horner's method on the whole column
+			output.col(q) = coefficients_[order].col(segment);
+			for(int k=order-1; k>=0; --k)
+			{
+				output.col(q) = output.col(q) * tau + coefficients_[k].col(segment);
+			}
+
+			for(size_t n=0; n<quaternion_rows_.size() && !single_point; ++n)
+			{
+				const int row = quaternion_rows_[n];
+				const Eigen::Quaterniond q0(waypoints_(row+3, segment), waypoints_(row, segment), waypoints_(row+1, segment), waypoints_(row+2, segment));
+				const Eigen::Quaterniond q1(waypoints_(row+3, segment+1), waypoints_(row, segment+1), waypoints_(row+1, segment+1), waypoints_(row+2, segment+1));
+				output.col(q).segment(row, 4) = q0.slerp(tau / (times_(segment+1) - times_(segment)), q1).coeffs();
+			}
+		}
+	}
+
+	inline void TrajectoryInterpolator::resample(const double period, Eigen::MatrixXd& output) const
+	{
+		if(period <= 0)
+		{
+			throw std::invalid_argument("Period must be positive");
+		}
+		const int num_samples = static_cast<int>(std::floor((getEndTime() - getStartTime()) / period + 1e-9)) + 1;
+		const Eigen::VectorXd query_times = Eigen::VectorXd::LinSpaced(num_samples, getStartTime(), getStartTime() + (num_samples - 1) * period);
+		evaluate(query_times, output);
+	}
+
+	/**
+	 * Resamples a list of timed waypoints of any type with valid conversion functions (e.g. geometry_msgs::Pose)
+	 * @param waypoints			The waypoints
+	 * @param times				The time of each waypoint, strictly increasing
+	 * @param period			The time between output samples
+	 * @param output			The resampled waypoints, from the time of the first waypoint to the last.
+	 *							Fields that are not converted (e.g. headers) are copied from the first waypoint
+	 * @param type				The interpolation between waypoints
+	 * @param quaternion_rows	The first index of each quaternion in the converted waypoints (e.g. {3} for Poses)
+	 */
+	template <class T> void resampleTrajectory(const std::vector<T>& waypoints, const std::vector<double>& times, const double period,
+											   std::vector<T>& output, TrajectoryInterpolator::Type type=TrajectoryInterpolator::CUBIC,
+											   const std::vector<int>& quaternion_rows=std::vector<int>())
+	{
+		if(waypoints.empty() || waypoints.size() != times.size())
+		{
+			throw std::invalid_argument("There must be one time for each waypoint");
+		}
+		Eigen::MatrixXd waypoint_matrix;
+		Eigen::VectorXd waypoint_vector;
+		for(size_t i=0; i<waypoints.size(); ++i)
+		{
+			convert(waypoints[i], waypoint_vector);
+			if(i == 0) waypoint_matrix.resize(waypoint_vector.size(), waypoints.size());
+			if(waypoint_vector.size() != waypoint_matrix.rows())
+			{
+				throw std::invalid_argument("All waypoints must have the same number of elements");
+			}
+			waypoint_matrix.col(i) = waypoint_vector;
+		}
+
+		const TrajectoryInterpolator interpolator(Eigen::Map<const Eigen::VectorXd>(times.data(), times.size()), waypoint_matrix, type, quaternion_rows);
+		Eigen::MatrixXd samples;
+		interpolator.resample(period, samples);
+
+		output.assign(samples.cols(), waypoints[0]);
+		std::vector<double> sample(samples.rows());
+		for(int i=0; i<samples.cols(); ++i)
+		{
+			Eigen::VectorXd::Map(sample.data(), sample.size()) = samples.col(i);
+			nrg_conversions::fromVec(sample, output[i]);
+		}
+	}
+
 } // end nrg_tools namespace
\ No newline at end of file
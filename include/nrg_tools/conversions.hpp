@@ -5,12 +5,17 @@
  */
 
 #include "ros_msgs_includes.h"
+#include "arena_allocator.hpp"
+#include "point_cloud_tools.hpp"
+#include "profiling.hpp"
 #include <Eigen/Eigen>
+#include <type_traits>
 
 // This file consists of 3 main sections:
 // 1. A list of functions that converts messages to std::vector's
 // 2. A list of functions that converts std::vector's to message types
 // 3. A template function to convert any 2 types (thru a std::vector)
+// followed by the converted sizes of fixed size types, and conversions of only some fields of a type
 
 // To add a message type to the available conversions, ALL YOU NEED TO DO is:
 // 1. Write a function (following the same form as the others in section 1) that
@@ -18,6 +23,8 @@
 // 2. Write a function (following the same form as the othersin section 2) that
 // 			converts a std::vector into your type
 // 3. If you copy the comments too, the documentation should be easily updated
+// The functions are templated on the allocator of the std::vector, so they also work on
+// vectors from a nrg_tools::MonotonicArena. Create any std::vector with the given allocator
 
 namespace nrg_conversions{
 
@@ -28,49 +35,57 @@ namespace nrg_conversions{
 	/**
 	 * Trivial case for std::vector to std::vector
 	 * @param input		A std::vector<double> input
+	 * @param alloc		The allocator of the output
 	 * @return 			Returns the same input
 	 */
-	const std::vector<double> toVec(const std::vector<double> input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const std::vector<double>& input, const Alloc& alloc=Alloc())
 	{
-		return input;
+		return std::vector<double, Alloc>(input.begin(), input.end(), alloc);
 	}
 
 	/**
 	 * Converts geometry_msgs::Vector3 to std::vector<double>
 	 * @param input		A geometry_msgs::Vector3 input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::Vector3 input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::Vector3 input, const Alloc& alloc=Alloc())
 	{
-		std::vector<double> output{input.x, input.y, input.z};
+		std::vector<double, Alloc> output({input.x, input.y, input.z}, alloc);
 		return output;
 	}
 
 	/**
 	 * Converts geometry_msgs::Quaternion to std::vector<double>
 	 * @param input		A geometry_msgs::Quaternion input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::Quaternion input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::Quaternion input, const Alloc& alloc=Alloc())
 	{
-		std::vector<double> output{input.x, input.y, input.z, input.w};
+		std::vector<double, Alloc> output({input.x, input.y, input.z, input.w}, alloc);
 		return output;
 	}
 
 	/**
 	 * Converts geometry_msgs::Accel to std::vector<double>
 	 * @param input		A geometry_msgs::Accel input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::Accel input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::Accel input, const Alloc& alloc=Alloc())
 	{
 		const geometry_msgs::Vector3 linear = input.linear;
 		const geometry_msgs::Vector3 angular = input.angular;
 
-		const std::vector<double> lin_std_vec = toVec(linear);
-		const std::vector<double> ang_std_vec = toVec(angular);
+		const std::vector<double, Alloc> lin_std_vec = toVec(linear, alloc);
+		const std::vector<double, Alloc> ang_std_vec = toVec(angular, alloc);
 
-		std::vector<double> output = lin_std_vec;
+		std::vector<double, Alloc> output = lin_std_vec;
 		output.insert(output.end(), ang_std_vec.begin(), ang_std_vec.end());
 		return output;
 	}
@@ -78,72 +93,83 @@ namespace nrg_conversions{
 	/**
 	 * Converts geometry_msgs::AccelStamped to std::vector<double>
 	 * @param input		A geometry_msgs::AccelStamped input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::AccelStamped input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::AccelStamped input, const Alloc& alloc=Alloc())
 	{
 		const geometry_msgs::Accel accel = input.accel;
-		return toVec(accel);
+		return toVec(accel, alloc);
 	}
 
 	/**
-	 * Converts Eigen::VectorXd to std::vector<double>
-	 * @param input		A Eigen::VectorXd input
+	 * Converts any Eigen vector (e.g. Eigen::VectorXd, Eigen::Vector3d, a segment, an Eigen::Map or an Eigen::Ref) to std::vector<double>
+	 * @param input		An Eigen vector input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const Eigen::VectorXd input)
+	template <class Derived, class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const Eigen::MatrixBase<Derived>& input, const Alloc& alloc=Alloc())
 	{
-		std::vector<double> output;
-		for(int i=0; i<input.size(); i++)
-		{
-			output.push_back(input[i]);
-		}
+		EIGEN_STATIC_ASSERT_VECTOR_ONLY(Derived);
+		std::vector<double, Alloc> output(input.size(), 0.0, alloc);
+		Eigen::Map<Eigen::Matrix<double, Derived::RowsAtCompileTime, Derived::ColsAtCompileTime> >(output.data(), input.rows(), input.cols()) =
+			input.template cast<double>();
 		return output;
 	}
 
 	/**
 	 * Converts geometry_msgs::Point to std::vector<double>
 	 * @param input		A geometry_msgs::Point input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::Point input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::Point input, const Alloc& alloc=Alloc())
 	{
-		std::vector<double> output{input.x, input.y, input.z};
+		std::vector<double, Alloc> output({input.x, input.y, input.z}, alloc);
 		return output;
 	}
 
 	/**
 	 * Converts geometry_msgs::Point32 to std::vector<double>
 	 * @param input		A geometry_msgs::Point32 input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::Point32 input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::Point32 input, const Alloc& alloc=Alloc())
 	{
-		std::vector<double> output{input.x, input.y, input.z};
+		std::vector<double, Alloc> output({input.x, input.y, input.z}, alloc);
 		return output;
 	}
 
 	/**
 	 * Converts geometry_msgs::PointStamped to std::vector<double>
 	 * @param input		A geometry_msgs::PointStamped input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::PointStamped input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::PointStamped input, const Alloc& alloc=Alloc())
 	{
 		const geometry_msgs::Point point = input.point;
-		return toVec(point);
+		return toVec(point, alloc);
 	}
 
 	/**
 	 * Converts geometry_msgs::Polygon to std::vector<double> point-by-point
 	 * such that the 4th element of the output is the second point's X (first) value
 	 * @param input		A geometry_msgs::Polygon input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::Polygon input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::Polygon& input, const Alloc& alloc=Alloc())
 	{
 		size_t num_points = input.points.size();
-		std::vector<double> output;
+		std::vector<double, Alloc> output(alloc);
 		for(size_t i=0; i<num_points; ++i)
 		{
 			output.push_back(input.points[i].x);
@@ -157,27 +183,30 @@ namespace nrg_conversions{
 	 * Converts geometry_msgs::PolygonStamped to std::vector<double> point-by-point
 	 * such that the 4th element of the output is the second point's X (first) value
 	 * @param input		A geometry_msgs::PolygonStamped input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::PolygonStamped input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::PolygonStamped& input, const Alloc& alloc=Alloc())
 	{
-		const geometry_msgs::Polygon poly = input.polygon;
-		return toVec(poly);
+		return toVec(input.polygon, alloc);
 	}
 
 	/**
 	 * Converts geometry_msgs::Pose to std::vector<double>
 	 * @param input		A geometry_msgs::Pose input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::Pose input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::Pose input, const Alloc& alloc=Alloc())
 	{
 		const geometry_msgs::Point point = input.position;
 		const geometry_msgs::Quaternion quat = input.orientation;
 
-		const std::vector<double> v1 = toVec(point);
-		const std::vector<double> v2 = toVec(quat);
-		std::vector<double> output = v1;
+		const std::vector<double, Alloc> v1 = toVec(point, alloc);
+		const std::vector<double, Alloc> v2 = toVec(quat, alloc);
+		std::vector<double, Alloc> output = v1;
 		output.insert(output.end(), v2.begin(), v2.end());
 		return output;
 	}
@@ -185,71 +214,83 @@ namespace nrg_conversions{
 	/**
 	 * Converts geometry_msgs::Pose2D to std::vector<double>
 	 * @param input		A geometry_msgs::Pose2D input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::Pose2D input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::Pose2D input, const Alloc& alloc=Alloc())
 	{
-		std::vector<double> output{input.x, input.y, input.theta};
+		std::vector<double, Alloc> output({input.x, input.y, input.theta}, alloc);
 		return output;
 	}
 
 	/**
 	 * Converts geometry_msgs::PoseStamped to std::vector<double>
 	 * @param input		A geometry_msgs::PoseStamped input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::PoseStamped input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::PoseStamped input, const Alloc& alloc=Alloc())
 	{
 		const geometry_msgs::Pose pose = input.pose;
-		return toVec(pose);
+		return toVec(pose, alloc);
 	}
 
 	/**
 	 * Converts tf::Quaternion to std::vector<double>
 	 * @param input		A tf::Quaternion input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const tf::Quaternion input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const tf::Quaternion input, const Alloc& alloc=Alloc())
 	{
-		std::vector<double> output{input[0], input[1], input[2], input[3]};
+		std::vector<double, Alloc> output({input[0], input[1], input[2], input[3]}, alloc);
 		return output;
 	}
 
 	/**
 	 * Converts tf2::Quaternion to std::vector<double>
 	 * @param input		A tf2::Quaternion input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const tf2::Quaternion input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const tf2::Quaternion input, const Alloc& alloc=Alloc())
 	{
-		std::vector<double> output{input[0], input[1], input[2], input[3]};
+		std::vector<double, Alloc> output({input[0], input[1], input[2], input[3]}, alloc);
 		return output;
 	}
 
 	/**
 	 * Converts geometry_msgs::QuaternionStamped to std::vector<double>
 	 * @param input		A geometry_msgs::QuaternionStamped input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::QuaternionStamped input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::QuaternionStamped input, const Alloc& alloc=Alloc())
 	{
 		const geometry_msgs::Quaternion quat = input.quaternion;
-		return toVec(quat);
+		return toVec(quat, alloc);
 	}
 
 	/**
 	 * Converts geometry_msgs::Transform to std::vector<double>
 	 * @param input		A geometry_msgs::Transform input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::Transform input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::Transform input, const Alloc& alloc=Alloc())
 	{
 		const geometry_msgs::Vector3 vec = input.translation;
 		const geometry_msgs::Quaternion quat = input.rotation;
 
-		const std::vector<double> v1 = toVec(vec);
-		const std::vector<double> v2 = toVec(quat);
-		std::vector<double> output = v1;
+		const std::vector<double, Alloc> v1 = toVec(vec, alloc);
+		const std::vector<double, Alloc> v2 = toVec(quat, alloc);
+		std::vector<double, Alloc> output = v1;
 		output.insert(output.end(), v2.begin(), v2.end());
 		return output;
 	}
@@ -257,27 +298,31 @@ namespace nrg_conversions{
 	/**
 	 * Converts geometry_msgs::TransformStamped to std::vector<double>
 	 * @param input		A geometry_msgs::TransformStamped input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::TransformStamped input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::TransformStamped input, const Alloc& alloc=Alloc())
 	{
 		const geometry_msgs::Transform tran = input.transform;
-		return toVec(tran);
+		return toVec(tran, alloc);
 	}
 
 	/**
 	 * Converts geometry_msgs::Twist to std::vector<double>
 	 * @param input		A geometry_msgs::Twist input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::Twist input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::Twist input, const Alloc& alloc=Alloc())
 	{
 		const geometry_msgs::Vector3 vec1 = input.linear;
 		const geometry_msgs::Vector3 vec2 = input.angular;
 
-		const std::vector<double> v1 = toVec(vec1);
-		const std::vector<double> v2 = toVec(vec2);
-		std::vector<double> output = v1;
+		const std::vector<double, Alloc> v1 = toVec(vec1, alloc);
+		const std::vector<double, Alloc> v2 = toVec(vec2, alloc);
+		std::vector<double, Alloc> output = v1;
 		output.insert(output.end(), v2.begin(), v2.end());
 		return output;
 	}
@@ -285,60 +330,70 @@ namespace nrg_conversions{
 	/**
 	 * Converts geometry_msgs::TwistStamped to std::vector<double>
 	 * @param input		A geometry_msgs::TwistStamped input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::TwistStamped input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::TwistStamped input, const Alloc& alloc=Alloc())
 	{
 		const geometry_msgs::Twist twist = input.twist;
-		return toVec(twist);
+		return toVec(twist, alloc);
 	}
 
 	/**
 	 * Converts tf::Vector3 to std::vector<double>
 	 * @param input		A tf::Vector3 input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const tf::Vector3 input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const tf::Vector3 input, const Alloc& alloc=Alloc())
 	{
-		std::vector<double> output{input.getX(), input.getY(), input.getZ()};
+		std::vector<double, Alloc> output({input.getX(), input.getY(), input.getZ()}, alloc);
 		return output;
 	}
 
 	/**
 	 * Converts tf2::Vector3 to std::vector<double>
 	 * @param input		A tf2::Vector3 input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const tf2::Vector3 input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const tf2::Vector3 input, const Alloc& alloc=Alloc())
 	{
-		std::vector<double> output{input.getX(), input.getY(), input.getZ()};
+		std::vector<double, Alloc> output({input.getX(), input.getY(), input.getZ()}, alloc);
 		return output;
 	}
 
 	/**
 	 * Converts geometry_msgs::Vector3Stamped to std::vector<double>
 	 * @param input		A geometry_msgs::Vector3Stamped input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::Vector3Stamped input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::Vector3Stamped input, const Alloc& alloc=Alloc())
 	{
 		const geometry_msgs::Vector3 vec = input.vector;
-		return toVec(vec);
+		return toVec(vec, alloc);
 	}
 
 	/**
 	 * Converts geometry_msgs::Wrench to std::vector<double>
 	 * @param input		A geometry_msgs::Wrench input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::Wrench input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::Wrench input, const Alloc& alloc=Alloc())
 	{
 		const geometry_msgs::Vector3 vec1 = input.force;
 		const geometry_msgs::Vector3 vec2 = input.torque;
 
-		const std::vector<double> v1 = toVec(vec1);
-		const std::vector<double> v2 = toVec(vec2);
-		std::vector<double> output = v1;
+		const std::vector<double, Alloc> v1 = toVec(vec1, alloc);
+		const std::vector<double, Alloc> v2 = toVec(vec2, alloc);
+		std::vector<double, Alloc> output = v1;
 		output.insert(output.end(), v2.begin(), v2.end());
 		return output;
 	}
@@ -346,12 +401,69 @@ namespace nrg_conversions{
 	/**
 	 * Converts geometry_msgs::WrenchStamped to std::vector<double>
 	 * @param input		A geometry_msgs::WrenchStamped input
+	 * @param alloc		The allocator of the output
 	 * @return 			A std::vector<double> that matches the input
 	 */
-	const std::vector<double> toVec(const geometry_msgs::WrenchStamped input)
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const geometry_msgs::WrenchStamped input, const Alloc& alloc=Alloc())
 	{
 		const geometry_msgs::Wrench wrench = input.wrench;
-		return toVec(wrench);
+		return toVec(wrench, alloc);
+	}
+
+	/**
+	 * Converts the xyz fields of a sensor_msgs::PointCloud2 to std::vector<double> point-by-point
+	 * such that the 4th element of the output is the second point's X (first) value.
+	 * Organized clouds are flattened row by row, and NaN points are kept.
+	 * For large clouds, use nrg_tools::PointCloudXYZView directly to avoid the copies
+	 * @param input		A sensor_msgs::PointCloud2 input
+	 * @param alloc		The allocator of the output
+	 * @return 			A std::vector<double> that matches the input, empty if the cloud has no usable xyz fields
+	 */
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const sensor_msgs::PointCloud2& input, const Alloc& alloc=Alloc())
+	{
+		Eigen::Matrix3Xd points;
+		nrg_tools::PointCloudXYZView view(input);
+		if(!view.gather(points)) return std::vector<double, Alloc>(alloc);
+		return std::vector<double, Alloc>(points.data(), points.data() + points.size(), alloc);
+	}
+
+	/**
+	 * Converts sensor_msgs::JointState to std::vector<double>. The output holds the positions,
+	 * then the velocities, then the efforts, in message order. Empty fields are skipped
+	 * @param input		A sensor_msgs::JointState input
+	 * @param alloc		The allocator of the output
+	 * @return 			A std::vector<double> that matches the input
+	 */
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const sensor_msgs::JointState& input, const Alloc& alloc=Alloc())
+	{
+		std::vector<double, Alloc> output(alloc);
+		output.reserve(input.position.size() + input.velocity.size() + input.effort.size());
+		output.insert(output.end(), input.position.begin(), input.position.end());
+		output.insert(output.end(), input.velocity.begin(), input.velocity.end());
+		output.insert(output.end(), input.effort.begin(), input.effort.end());
+		return output;
+	}
+
+	/**
+	 * Converts trajectory_msgs::JointTrajectoryPoint to std::vector<double>. The output holds the positions,
+	 * then the velocities, then the accelerations, then the efforts. Empty fields are skipped
+	 * @param input		A trajectory_msgs::JointTrajectoryPoint input
+	 * @param alloc		The allocator of the output
+	 * @return 			A std::vector<double> that matches the input
+	 */
+	template <class Alloc=std::allocator<double> >
+	const std::vector<double, Alloc> toVec(const trajectory_msgs::JointTrajectoryPoint& input, const Alloc& alloc=Alloc())
+	{
+		std::vector<double, Alloc> output(alloc);
+		output.reserve(input.positions.size() + input.velocities.size() + input.accelerations.size() + input.effort.size());
+		output.insert(output.end(), input.positions.begin(), input.positions.end());
+		output.insert(output.end(), input.velocities.begin(), input.velocities.end());
+		output.insert(output.end(), input.accelerations.begin(), input.accelerations.end());
+		output.insert(output.end(), input.effort.begin(), input.effort.end());
+		return output;
 	}
 
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -364,9 +476,10 @@ namespace nrg_conversions{
 	 * @param output	The same std::vector<double> as output
 	 * @return 			Always true for the trivial case
 	 */
-	const bool fromVec(const std::vector<double>& input, std::vector<double>& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, std::vector<double>& output)
 	{
-		output = input;
+		output.assign(input.begin(), input.end());
 		return true;
 	}
 
@@ -376,7 +489,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::Vector3 that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::Vector3& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::Vector3& output)
 	{
 		if(input.size() != 3) return false;
 		geometry_msgs::Vector3 vec3;
@@ -391,11 +505,12 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::Quaternion that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::Quaternion& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::Quaternion& output)
 	{
 		if(input.size() != 4) return false;
 		geometry_msgs::Quaternion quat;
-		quat.x = input[0]; quat.y = input[1]; quat.z = input[2]; quat.w = input[2];
+		quat.x = input[0]; quat.y = input[1]; quat.z = input[2]; quat.w = input[3];
 		output = quat;
 		return true;
 	}
@@ -406,7 +521,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::Accel that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::Accel& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::Accel& output)
 	{
 		if(input.size() != 6) return false;
 		geometry_msgs::Accel accel;
@@ -422,7 +538,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::AccelStamped that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::AccelStamped& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::AccelStamped& output)
 	{
 		geometry_msgs::Accel accel;
 		const bool val = fromVec(input, accel);
@@ -432,19 +549,24 @@ namespace nrg_conversions{
 	}
 
 	/**
-	 * Converts a std::vector<double> into a Eigen::VectorXd
+	 * Converts a std::vector<double> into any Eigen vector (e.g. Eigen::VectorXd, Eigen::Vector3d, a segment, an Eigen::Map or an Eigen::Ref)
 	 * @param input		A std::vector<double> input
-	 * @param output	A Eigen::VectorXd that matches the input
-	 * @return 			Returns 'true'
+	 * @param output	An Eigen vector that matches the input. Only resized if it is a dynamic size vector
+	 * @return 			Returns 'true' if the input is the size of the output or the output was resized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, Eigen::VectorXd& output)
+	template <class Alloc, class Derived>
+	const bool fromVec(const std::vector<double, Alloc>& input, Eigen::MatrixBase<Derived>& output)
 	{
-		Eigen::VectorXd vec(input.size());
-		for(int i=0; i<input.size(); i++)
+		EIGEN_STATIC_ASSERT_VECTOR_ONLY(Derived);
+		const bool resizable = (Derived::SizeAtCompileTime == Eigen::Dynamic) &&
+							   std::is_base_of<Eigen::PlainObjectBase<typename Derived::PlainObject>, Derived>::value;
+		if(output.size() != static_cast<Eigen::Index>(input.size()))
 		{
-			vec[i] = input[i];
+			if(!resizable) return false;
+			output.derived().resize(input.size());
 		}
-		output = vec;
+		output = Eigen::Map<const Eigen::Matrix<double, Derived::RowsAtCompileTime, Derived::ColsAtCompileTime> >(
+			input.data(), output.rows(), output.cols()).template cast<typename Derived::Scalar>();
 		return true;
 	}
 
@@ -454,7 +576,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::Point that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::Point& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::Point& output)
 	{
 		if(input.size() != 3) return false;
 		geometry_msgs::Point point;
@@ -469,7 +592,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::Point32 that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::Point32& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::Point32& output)
 	{
 		if(input.size() != 3) return false;
 		geometry_msgs::Point32 point;
@@ -484,7 +608,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::PointStamped that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::PointStamped& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::PointStamped& output)
 	{
 		geometry_msgs::Point point;
 		const bool val = fromVec(input, point);
@@ -501,22 +626,18 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::Polygon that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::Polygon& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::Polygon& output)
 	{
 		if(input.size() % 3 != 0) return false;
-		geometry_msgs::Polygon poly;
-		geometry_msgs::Point32 point;
-
 		size_t num_points = input.size() / 3;
+		output.points.resize(num_points);
 		for(size_t i=0; i<num_points; ++i)
 		{
-			point.x = input[3*i];
-			point.y = input[3*i+1];
-			point.z = input[3*i+2];
-			poly.points.push_back(point);
+			output.points[i].x = input[3*i];
+			output.points[i].y = input[3*i+1];
+			output.points[i].z = input[3*i+2];
 		}
-
-		output = poly;
 		return true;
 	}
 
@@ -528,11 +649,12 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::PolygonStamped that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::PolygonStamped& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::PolygonStamped& output)
 	{
-		geometry_msgs::Polygon poly;
-		const bool val = fromVec(input, poly);
-		output.polygon = poly;
+		// Straight into the output, so its points can be reused
+		const bool val = fromVec(input, output.polygon);
+		if(!val) output.polygon.points.clear();
 		
 		return val;
 	}
@@ -543,7 +665,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::Pose that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::Pose& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::Pose& output)
 	{
 		if(input.size() != 7) return false;
 		geometry_msgs::Point point;
@@ -564,7 +687,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::Pose2D that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::Pose2D& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::Pose2D& output)
 	{
 		if(input.size() != 3) return false;
 		geometry_msgs::Pose2D pose;
@@ -579,7 +703,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::PoseStamped that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::PoseStamped& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::PoseStamped& output)
 	{
 		geometry_msgs::Pose pose;
 		const bool val = fromVec(input, pose);
@@ -594,7 +719,8 @@ namespace nrg_conversions{
 	 * @param output	A tf::Quaternion that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, tf::Quaternion& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, tf::Quaternion& output)
 	{
 		if(input.size() != 4) return false;
 		tf::Quaternion quat(input[0], input[1], input[2], input[3]);
@@ -608,7 +734,8 @@ namespace nrg_conversions{
 	 * @param output	A tf2::Quaternion that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, tf2::Quaternion& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, tf2::Quaternion& output)
 	{
 		if(input.size() != 4) return false;
 		tf2::Quaternion quat(input[0], input[1], input[2], input[3]);
@@ -622,7 +749,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::QuaternionStamped that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::QuaternionStamped& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::QuaternionStamped& output)
 	{
 		geometry_msgs::Quaternion quat;
 		const bool val = fromVec(input, quat);
@@ -637,7 +765,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::Transform that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::Transform& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::Transform& output)
 	{
 		if(input.size() != 7) return false;
 		geometry_msgs::Vector3 vec;
@@ -658,7 +787,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::TransformStamped that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::TransformStamped& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::TransformStamped& output)
 	{
 		geometry_msgs::Transform tran;
 		const bool val = fromVec(input, tran);
@@ -673,7 +803,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::Twist that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::Twist& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::Twist& output)
 	{
 		if(input.size() != 6) return false;
 		geometry_msgs::Twist twist;
@@ -691,7 +822,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::TwistStamped that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::TwistStamped& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::TwistStamped& output)
 	{
 		geometry_msgs::Twist twist;
 		const bool val = fromVec(input, twist);
@@ -706,7 +838,8 @@ namespace nrg_conversions{
 	 * @param output	A tf::Vector3 that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, tf::Vector3& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, tf::Vector3& output)
 	{
 		if(input.size() != 3) return false;
 		tf::Vector3 vec(input[0], input[1], input[2]);
@@ -720,7 +853,8 @@ namespace nrg_conversions{
 	 * @param output	A tf2::Vector3 that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, tf2::Vector3& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, tf2::Vector3& output)
 	{
 		if(input.size() != 3) return false;
 		tf2::Vector3 vec(input[0], input[1], input[2]);
@@ -734,7 +868,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::Vector3Stamped that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::Vector3Stamped& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::Vector3Stamped& output)
 	{
 		geometry_msgs::Vector3 vec;
 		const bool val = fromVec(input, vec);
@@ -749,7 +884,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::Wrench that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::Wrench& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::Wrench& output)
 	{
 		if(input.size() != 6) return false;
 		geometry_msgs::Wrench wrench;
@@ -767,7 +903,8 @@ namespace nrg_conversions{
 	 * @param output	A geometry_msgs::WrenchStamped that matches the input
 	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
 	 */
-	const bool fromVec(const std::vector<double>& input, geometry_msgs::WrenchStamped& output)
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, geometry_msgs::WrenchStamped& output)
 	{
 		geometry_msgs::Wrench wrench;
 		const bool val = fromVec(input, wrench);
@@ -775,6 +912,157 @@ namespace nrg_conversions{
 		
 		return val;
 	}
+
+	/**
+	 * Converts a std::vector<double> into an unorganized sensor_msgs::PointCloud2 point-by-point
+	 * such that the first 3 elements of the input are the first point, the next 3 elements
+	 * are the second point, etc. The cloud has FLOAT32 "x", "y" and "z" fields, and the header is kept
+	 * @param input		A std::vector<double> input
+	 * @param output	A sensor_msgs::PointCloud2 that matches the input
+	 * @return 			Returns 'true' if the input is adequately sized, 'false' otherwise
+	 */
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, sensor_msgs::PointCloud2& output)
+	{
+		if(input.size() % 3 != 0) return false;
+		const size_t num_points = input.size() / 3;
+
+		output.fields.resize(3);
+		const char* names[3] = {"x", "y", "z"};
+		for(size_t i=0; i<3; ++i)
+		{
+			output.fields[i].name = names[i];
+			output.fields[i].offset = i*sizeof(float);
+			output.fields[i].datatype = sensor_msgs::PointField::FLOAT32;
+			output.fields[i].count = 1;
+		}
+		output.height = 1;
+		output.width = num_points;
+		output.is_bigendian = false;
+		output.point_step = 3*sizeof(float);
+		output.row_step = output.point_step * num_points;
+		output.is_dense = false;
+
+		output.data.resize(output.row_step);
+		float* data = reinterpret_cast<float*>(output.data.data());
+		for(size_t i=0; i<input.size(); ++i)
+		{
+			data[i] = input[i];
+		}
+		return true;
+	}
+
+	/**
+	 * Converts a std::vector<double> into a sensor_msgs::JointState. The number of joints is taken
+	 * from the names already in the output (or is the input size if it has none), and the input is split
+	 * into positions, then velocities, then efforts. Names and header are kept
+	 * @param input		A std::vector<double> input
+	 * @param output	A sensor_msgs::JointState that matches the input
+	 * @return 			Returns 'true' if the input is 1, 2 or 3 times the number of joints, 'false' otherwise
+	 */
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, sensor_msgs::JointState& output)
+	{
+		const size_t num_joints = output.name.empty() ? input.size() : output.name.size();
+		if(num_joints == 0 || input.size() % num_joints != 0 || input.size() / num_joints > 3) return false;
+		const size_t num_fields = input.size() / num_joints;
+
+		std::vector<double>* fields[3] = {&output.position, &output.velocity, &output.effort};
+		for(size_t i=0; i<3; ++i)
+		{
+			if(i < num_fields) fields[i]->assign(input.begin() + i*num_joints, input.begin() + (i+1)*num_joints);
+			else fields[i]->clear();
+		}
+		return true;
+	}
+
+	/**
+	 * Converts a std::vector<double> into a trajectory_msgs::JointTrajectoryPoint. The number of joints is taken
+	 * from the positions already in the output (or is the input size if it has none), and the input is split
+	 * into positions, then velocities, then accelerations, then efforts. time_from_start is kept
+	 * @param input		A std::vector<double> input
+	 * @param output	A trajectory_msgs::JointTrajectoryPoint that matches the input
+	 * @return 			Returns 'true' if the input is 1 to 4 times the number of joints, 'false' otherwise
+	 */
+	template <class Alloc>
+	const bool fromVec(const std::vector<double, Alloc>& input, trajectory_msgs::JointTrajectoryPoint& output)
+	{
+		const size_t num_joints = output.positions.empty() ? input.size() : output.positions.size();
+		if(num_joints == 0 || input.size() % num_joints != 0 || input.size() / num_joints > 4) return false;
+		const size_t num_fields = input.size() / num_joints;
+
+		std::vector<double>* fields[4] = {&output.positions, &output.velocities, &output.accelerations, &output.effort};
+		for(size_t i=0; i<4; ++i)
+		{
+			if(i < num_fields) fields[i]->assign(input.begin() + i*num_joints, input.begin() + (i+1)*num_joints);
+			else fields[i]->clear();
+		}
+		return true;
+	}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~ CONVERTED SIZES ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+	template <class T> struct Void {typedef void type;};
+
+	/**
+	 * The number of values a type converts to, if it is known at compile time, and Eigen::Dynamic otherwise.
+	 * Used to check conversions between fixed size types when they are compiled.
+	 * New message types with a fixed layout can add a specialization
+	 */
+	template <class T, class Enable=void> struct ConvertedSize {static const int value = Eigen::Dynamic;};
+	template <class T> struct ConvertedSize<T, typename Void<decltype(T::SizeAtCompileTime)>::type> {static const int value = T::SizeAtCompileTime;};
+	template <> struct ConvertedSize<geometry_msgs::Accel> {static const int value = 6;};
+	template <> struct ConvertedSize<geometry_msgs::AccelStamped> {static const int value = 6;};
+	template <> struct ConvertedSize<geometry_msgs::Point> {static const int value = 3;};
+	template <> struct ConvertedSize<geometry_msgs::Point32> {static const int value = 3;};
+	template <> struct ConvertedSize<geometry_msgs::PointStamped> {static const int value = 3;};
+	template <> struct ConvertedSize<geometry_msgs::Pose> {static const int value = 7;};
+	template <> struct ConvertedSize<geometry_msgs::Pose2D> {static const int value = 3;};
+	template <> struct ConvertedSize<geometry_msgs::PoseStamped> {static const int value = 7;};
+	template <> struct ConvertedSize<geometry_msgs::Quaternion> {static const int value = 4;};
+	template <> struct ConvertedSize<geometry_msgs::QuaternionStamped> {static const int value = 4;};
+	template <> struct ConvertedSize<geometry_msgs::Transform> {static const int value = 7;};
+	template <> struct ConvertedSize<geometry_msgs::TransformStamped> {static const int value = 7;};
+	template <> struct ConvertedSize<geometry_msgs::Twist> {static const int value = 6;};
+	template <> struct ConvertedSize<geometry_msgs::TwistStamped> {static const int value = 6;};
+	template <> struct ConvertedSize<geometry_msgs::Vector3> {static const int value = 3;};
+	template <> struct ConvertedSize<geometry_msgs::Vector3Stamped> {static const int value = 3;};
+	template <> struct ConvertedSize<geometry_msgs::Wrench> {static const int value = 6;};
+	template <> struct ConvertedSize<geometry_msgs::WrenchStamped> {static const int value = 6;};
+	template <> struct ConvertedSize<tf::Quaternion> {static const int value = 4;};
+	template <> struct ConvertedSize<tf::Vector3> {static const int value = 3;};
+	template <> struct ConvertedSize<tf2::Quaternion> {static const int value = 4;};
+	template <> struct ConvertedSize<tf2::Vector3> {static const int value = 3;};
+
+	/**
+	 * 'true' unless both types have a fixed size, and the sizes differ
+	 */
+	template <class T, class U> struct ConvertedSizesMatch
+	{
+		static const bool value = ConvertedSize<T>::value == Eigen::Dynamic || ConvertedSize<U>::value == Eigen::Dynamic ||
+								  ConvertedSize<T>::value == ConvertedSize<U>::value;
+	};
+
+	/**
+	 * Converts through a std::vector from the heap, for types whose size is only known at run time
+	 */
+	template <class T, class U> const bool convertThroughVector(const T &a, U &b, std::false_type)
+	{
+		return fromVec(toVec(a), b);
+	}
+
+	/**
+	 * Converts through a std::vector on the stack, for types of a small fixed size
+	 */
+	template <class T, class U> const bool convertThroughVector(const T &a, U &b, std::true_type)
+	{
+		alignas(double) unsigned char buffer[32 * sizeof(double)];
+		nrg_tools::MonotonicArena arena(buffer, sizeof(buffer));
+		return fromVec(toVec(a, nrg_tools::ArenaAllocator<double>(arena)), b);
+	}
+
 } // end nrg_conversions namespace
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // ~~~~~~~~~~~~~~~~~~~~~~~ TEMPLATE FOR CONVERT() ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -789,7 +1077,203 @@ namespace nrg_tools{
 	 */
 	template <class T, class U> const bool convert (const T &a, U &b)
 	{
-		return nrg_conversions::fromVec(nrg_conversions::toVec(a), b);
+		NRG_PROFILE_SCOPE("convert");
+		static_assert(nrg_conversions::ConvertedSizesMatch<T, U>::value, "Converting between fixed size types of different sizes");
+		// If either side has a small fixed size, the temporary fits on the stack
+		const int size = (nrg_conversions::ConvertedSize<T>::value != Eigen::Dynamic) ? nrg_conversions::ConvertedSize<T>::value
+																					 : nrg_conversions::ConvertedSize<U>::value;
+		return nrg_conversions::convertThroughVector(a, b, std::integral_constant<bool, size != Eigen::Dynamic && size <= 16>());
+	}
+
+	/**
+	 * Converts into an Eigen expression that is not an lvalue, e.g. convert(wrench, vector.segment<3>(0)) or
+	 * convert(twist, Eigen::Map<Eigen::Matrix<double, 6, 1> >(buffer)). The expression must already be the right size
+	 * @param a		The onject to convert from
+	 * @param b 	The Eigen expression to write into
+	 * @return 		Returns 'true' if the conversion was successful, 'false' otherwise
+	 */
+	template <class T, class Derived> const bool convert (const T &a, const Eigen::MatrixBase<Derived> &b)
+	{
+		return convert(a, const_cast<Derived&>(b.derived()));
+	}
+
+	/**
+	 * Same as convert(a, b), but the temporary std::vector is allocated with the given allocator
+	 * (e.g. nrg_tools::ArenaAllocator<double>(arena), so the conversion does not use the heap)
+	 * @param a		The onject to convert from
+	 * @param b 	The converted object
+	 * @param alloc	The allocator of the temporary
+	 * @return 		Returns 'true' if the conversion was successful, 'false' otherwise
+	 */
+	template <class T, class U, class Alloc> const bool convert (const T &a, U &b, const Alloc& alloc)
+	{
+		NRG_PROFILE_SCOPE("convert");
+		static_assert(nrg_conversions::ConvertedSizesMatch<T, U>::value, "Converting between fixed size types of different sizes");
+		return nrg_conversions::fromVec(nrg_conversions::toVec(a, alloc), b);
+	}
+
+} // end nrg_tools namespace
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~ FIELD SELECTION ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+namespace nrg_tools{
+	/**
+	 * Selects a range of the converted values of any type, e.g. Fields<2, 4> of a std::vector.
+	 * A Size of Eigen::Dynamic selects everything from Start to the end. The other values of a message
+	 * are kept by converting the whole message, so for messages prefer the names in nrg_tools::fields
+	 */
+	template <int Start, int Size=Eigen::Dynamic> struct Fields
+	{
+		static_assert(Start >= 0 && (Size > 0 || Size == Eigen::Dynamic), "Fields must select at least one value");
+		static const int start = Start;
+		static const int size = Size;
+		static const bool is_member = false;
+	};
+
+	/**
+	 * Gets the message inside a stamped message, so a selection of a type also works on its stamped version
+	 */
+	template <class T> T& unstamped(T& input) {return input;}
+	template <class T> const T& unstamped(const T& input) {return input;}
+	inline geometry_msgs::Accel& unstamped(geometry_msgs::AccelStamped& input) {return input.accel;}
+	inline const geometry_msgs::Accel& unstamped(const geometry_msgs::AccelStamped& input) {return input.accel;}
+	inline geometry_msgs::Pose& unstamped(geometry_msgs::PoseStamped& input) {return input.pose;}
+	inline const geometry_msgs::Pose& unstamped(const geometry_msgs::PoseStamped& input) {return input.pose;}
+	inline geometry_msgs::Transform& unstamped(geometry_msgs::TransformStamped& input) {return input.transform;}
+	inline const geometry_msgs::Transform& unstamped(const geometry_msgs::TransformStamped& input) {return input.transform;}
+	inline geometry_msgs::Twist& unstamped(geometry_msgs::TwistStamped& input) {return input.twist;}
+	inline const geometry_msgs::Twist& unstamped(const geometry_msgs::TwistStamped& input) {return input.twist;}
+	inline geometry_msgs::Wrench& unstamped(geometry_msgs::WrenchStamped& input) {return input.wrench;}
+	inline const geometry_msgs::Wrench& unstamped(const geometry_msgs::WrenchStamped& input) {return input.wrench;}
+
+	// Selects a named field of a message (e.g. Wrench::force), so only that field is read or written.
+	// Only compiles for messages that have the field, so e.g. a Force selection cannot be applied to a Pose
+#define NRG_FIELD_SELECTION(Name, member, Start, Size) \
+	struct Name : Fields<Start, Size> \
+	{ \
+		static const bool is_member = true; \
+		template <class T> static auto get(T& input) -> decltype((unstamped(input).member)) {return unstamped(input).member;} \
+	}
+
+	namespace fields{
+		typedef Fields<0> All;
+		NRG_FIELD_SELECTION(Force, force, 0, 3);				// Wrench, WrenchStamped
+		NRG_FIELD_SELECTION(Torque, torque, 3, 3);
+		NRG_FIELD_SELECTION(Linear, linear, 0, 3);				// Twist, TwistStamped, Accel, AccelStamped
+		NRG_FIELD_SELECTION(Angular, angular, 3, 3);
+		NRG_FIELD_SELECTION(Position, position, 0, 3);			// Pose, PoseStamped
+		NRG_FIELD_SELECTION(Orientation, orientation, 3, 4);
+		NRG_FIELD_SELECTION(Translation, translation, 0, 3);	// Transform, TransformStamped
+		NRG_FIELD_SELECTION(Rotation, rotation, 3, 4);
+	} // end fields namespace
+
+#undef NRG_FIELD_SELECTION
+
+	/**
+	 * The type of the field a named selection reads in T, or void if T does not have it
+	 */
+	template <class Selection, class T, class Enable=void> struct SelectedMember {typedef void type;};
+	template <class Selection, class T> struct SelectedMember<Selection, T,
+		typename nrg_conversions::Void<decltype(Selection::get(std::declval<T&>()))>::type>
+	{
+		typedef typename std::decay<decltype(Selection::get(std::declval<T&>()))>::type type;
+	};
+
+	/**
+	 * 'true' if a selection applies to a type: a named selection needs the type to have its field,
+	 * and a range needs to fit in the type (or the size of the type to only be known at run time)
+	 */
+	template <class Selection, class T> struct FieldsFit
+	{
+		static const bool value = Selection::is_member ?
+			nrg_conversions::ConvertedSize<typename SelectedMember<Selection, T>::type>::value == Selection::size :
+			(nrg_conversions::ConvertedSize<T>::value == Eigen::Dynamic ||
+			 Selection::start + (Selection::size == Eigen::Dynamic ? 1 : Selection::size) <= nrg_conversions::ConvertedSize<T>::value);
+	};
+
+	namespace selection_detail{
+		// Named selections convert only their field
+		template <class Selection, class T, class U> const bool extract(const T &a, U &b, std::true_type)
+		{
+			return convert(Selection::get(a), b);
+		}
+
+		template <class Selection, class T, class U> const bool write(const T &a, U &b, std::true_type)
+		{
+			return convert(a, Selection::get(b));
+		}
+
+		// Ranges flatten the whole object, on the stack for small fixed size types
+		template <class Selection, class T, class U> const bool extract(const T &a, U &b, std::false_type)
+		{
+			alignas(double) unsigned char buffer[32 * sizeof(double)];
+			MonotonicArena arena(buffer, sizeof(buffer));
+			const ArenaAllocator<double> alloc(arena);
+			const ArenaVector values = nrg_conversions::toVec(a, alloc);
+			if(Selection::start == 0 && Selection::size == Eigen::Dynamic)
+			{
+				return nrg_conversions::fromVec(values, b);
+			}
+
+			const size_t end = (Selection::size == Eigen::Dynamic) ? values.size() : Selection::start + Selection::size;
+			if(end > values.size() || end <= static_cast<size_t>(Selection::start)) return false;
+			const ArenaVector selected(values.begin() + Selection::start, values.begin() + end, alloc);
+			return nrg_conversions::fromVec(selected, b);
+		}
+
+		template <class Selection, class T, class U> const bool write(const T &a, U &b, std::false_type)
+		{
+			alignas(double) unsigned char buffer[32 * sizeof(double)];
+			MonotonicArena arena(buffer, sizeof(buffer));
+			const ArenaAllocator<double> alloc(arena);
+			const ArenaVector selected = nrg_conversions::toVec(a, alloc);
+			if(Selection::start == 0 && Selection::size == Eigen::Dynamic)
+			{
+				return nrg_conversions::fromVec(selected, b);
+			}
+
+			ArenaVector values = nrg_conversions::toVec(b, alloc);
+			if((Selection::size != Eigen::Dynamic && selected.size() != static_cast<size_t>(Selection::size))
+				|| Selection::start + selected.size() > values.size())
+			{
+				return false;
+			}
+			std::copy(selected.begin(), selected.end(), values.begin() + Selection::start);
+			return nrg_conversions::fromVec(values, b);
+		}
+	} // end selection_detail namespace
+
+	/**
+	 * Converts only some fields of an object, e.g. extractFields<fields::Force>(wrench_stamped, force_vector).
+	 * Named selections only convert their field, so this does not use the heap unless the output does
+	 * @param a		The object to take the fields from
+	 * @param b 	The selected fields. Must have as many values as the selection
+	 * @return 		Returns 'true' if the conversion was successful, 'false' otherwise
+	 */
+	template <class Selection, class T, class U> const bool extractFields(const T &a, U &b)
+	{
+		NRG_PROFILE_SCOPE("extractFields");
+		static_assert(FieldsFit<Selection, T>::value, "Selected fields are not part of the type");
+		static_assert(Selection::size == Eigen::Dynamic || nrg_conversions::ConvertedSize<U>::value == Eigen::Dynamic ||
+					  Selection::size == nrg_conversions::ConvertedSize<U>::value, "Output size does not match the selected fields");
+		return selection_detail::extract<Selection>(a, b, std::integral_constant<bool, Selection::is_member>());
+	}
+
+	/**
+	 * Writes only some fields of an object, keeping the others, e.g. writeFields<fields::Position>(position, pose).
+	 * Named selections only write their field, without converting the rest of the object
+	 * @param a		The values of the selected fields. Must have as many values as the selection
+	 * @param b 	The object to write the fields into
+	 * @return 		Returns 'true' if the conversion was successful, 'false' otherwise
+	 */
+	template <class Selection, class T, class U> const bool writeFields(const T &a, U &b)
+	{
+		NRG_PROFILE_SCOPE("writeFields");
+		static_assert(FieldsFit<Selection, U>::value, "Selected fields are not part of the type");
+		static_assert(Selection::size == Eigen::Dynamic || nrg_conversions::ConvertedSize<T>::value == Eigen::Dynamic ||
+					  Selection::size == nrg_conversions::ConvertedSize<T>::value, "Input size does not match the selected fields");
+		return selection_detail::write<Selection>(a, b, std::integral_constant<bool, Selection::is_member>());
 	}
 
-} // end nrg_tools namespace
\ No newline at end of file
+} // end nrg_tools namespace
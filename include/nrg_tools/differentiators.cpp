@@ -0,0 +1,146 @@
+#pragma once
+
+#include <differentiators.h>
+#include <conversions.hpp>
+#include <profiling.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+using namespace nrg_tools;
+
+BasicDifferentiator::BasicDifferentiator(const std::vector<double>& init_values, double time_step, Method method,
+										 double filter_coefficient, int window_size, int polynomial_order)
+{
+	if(time_step <= 0)
+	{
+		throw std::invalid_argument("Time step must be positive");
+	}
+	method_ = method;
+	num_channels_ = init_values.size();
+	nominal_time_step_ = time_step;
+	filter_coeff_ = filter_coefficient;
+
+	if(method_ == SAVITZKY_GOLAY)
+	{
+		if(polynomial_order < 1 || window_size <= polynomial_order)
+		{
+			throw std::invalid_argument("Polynomial order must be positive and less than the window size");
+		}
+		window_size_ = window_size;
+
+		// Least squares fit of the polynomial to the window, with the newest measurement at time 0.
+		// Each row of the solution gives one polynomial coefficient as a weighted sum of the measurements
+		Eigen::MatrixXd times(window_size_, polynomial_order + 1);
+		for(size_t age=0; age<window_size_; ++age)
+		{
+			for(int power=0; power<=polynomial_order; ++power)
+			{
+				times(age, power) = std::pow(-static_cast<double>(age), power);
+			}
+		}
+		const Eigen::MatrixXd weights = (times.transpose() * times).ldlt().solve(times.transpose());
+		velocity_weights_.resize(window_size_);
+		acceleration_weights_.assign(window_size_, 0.0);
+		for(size_t age=0; age<window_size_; ++age)
+		{
+			velocity_weights_[age] = weights(1, age);
+			if(polynomial_order >= 2) acceleration_weights_[age] = 2 * weights(2, age);
+		}
+		window_.resize(window_size_ * num_channels_);
+		time_steps_.resize(window_size_);
+	}
+	reset(init_values);
+}
+
+void BasicDifferentiator::update(const std::vector<double>& new_measurements, double time_step)
+{
+	NRG_PROFILE_SCOPE("BasicDifferentiator::update");
+	if(new_measurements.size() != num_channels_)
+	{
+		throw std::out_of_range("New Measurement vector must be same size as the number of channels");
+	}
+	if(time_step <= 0)
+	{
+		time_step = nominal_time_step_;
+	}
+
+	if(method_ == LOW_PASS)
+	{
+		const double gain = 1. / (1. + filter_coeff_);
+		for(size_t i=0; i<num_channels_; ++i)
+		{
+			const double raw_velocity = (new_measurements[i] - previous_measurement_[i]) / time_step;
+			const double velocity = gain * (raw_velocity + previous_raw_velocity_[i] - (1. - filter_coeff_) * velocity_[i]);
+			const double raw_acceleration = (velocity - velocity_[i]) / time_step;
+			acceleration_[i] = gain * (raw_acceleration + previous_raw_acceleration_[i] - (1. - filter_coeff_) * acceleration_[i]);
+
+			previous_measurement_[i] = new_measurements[i];
+			previous_raw_velocity_[i] = raw_velocity;
+			previous_raw_acceleration_[i] = raw_acceleration;
+			velocity_[i] = velocity;
+		}
+		return;
+	}
+
+	// Replace the oldest measurement in the window
+	const size_t newest_slot = time_ % window_size_;
+	++time_;
+	time_step_sum_ += time_step - time_steps_[newest_slot];
+	time_steps_[newest_slot] = time_step;
+	std::copy(new_measurements.begin(), new_measurements.end(), window_.begin() + newest_slot * num_channels_);
+
+	const double average_step = time_step_sum_ / window_size_;
+	std::fill(velocity_.begin(), velocity_.end(), 0.0);
+	std::fill(acceleration_.begin(), acceleration_.end(), 0.0);
+	for(size_t age=0; age<window_size_; ++age)
+	{
+		const double* window = &window_[((newest_slot + window_size_ - age) % window_size_) * num_channels_];
+		const double velocity_weight = velocity_weights_[age] / average_step;
+		const double acceleration_weight = acceleration_weights_[age] / (average_step * average_step);
+		for(size_t i=0; i<num_channels_; ++i)
+		{
+			velocity_[i] += velocity_weight * window[i];
+			acceleration_[i] += acceleration_weight * window[i];
+		}
+	}
+}
+
+template <class T>
+void BasicDifferentiator::update(const T& new_measurement, double time_step)
+{
+	convert(new_measurement, scratch_);
+	update(scratch_, time_step);
+}
+
+template <class T>
+void BasicDifferentiator::updateStamped(const T& new_measurement)
+{
+	const double stamp = new_measurement.header.stamp.toSec();
+	const double time_step = has_stamp_ ? stamp - last_stamp_ : 0.0;
+	last_stamp_ = stamp;
+	has_stamp_ = true;
+	update(new_measurement, time_step);
+}
+
+void BasicDifferentiator::reset(const std::vector<double>& reset_values)
+{
+	if(reset_values.size() != num_channels_)
+	{
+		throw std::out_of_range("Reset Values vector must be same size as the number of channels");
+	}
+	velocity_.assign(num_channels_, 0.0);
+	acceleration_.assign(num_channels_, 0.0);
+	previous_measurement_ = reset_values;
+	previous_raw_velocity_.assign(num_channels_, 0.0);
+	previous_raw_acceleration_.assign(num_channels_, 0.0);
+
+	// A window full of the reset value has no slope
+	time_ = 0;
+	for(size_t slot=0; slot<time_steps_.size(); ++slot)
+	{
+		std::copy(reset_values.begin(), reset_values.end(), window_.begin() + slot * num_channels_);
+		time_steps_[slot] = nominal_time_step_;
+	}
+	time_step_sum_ = nominal_time_step_ * time_steps_.size();
+	has_stamp_ = false;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace nrg_tools{
+	/**
+	 * \class BasicDifferentiator
+	 * Estimates the velocity and acceleration of a vector of values (channels), with no ROS capabilities.
+	 * Replaces finite differencing followed by a BasicLowPassMultiFilter: each update differentiates and
+	 * smooths every channel in a single pass over separate arrays of state, without allocating.
+	 * Two methods are available:
+	 * LOW_PASS:		The finite difference is smoothed by the same filter as BasicLowPassFilter, and differenced
+	 *					and smoothed again for the acceleration
+	 * SAVITZKY_GOLAY:	A polynomial is fit (by least squares) to the last window_size measurements, and its
+	 *					derivatives are taken at the newest one. The fit reduces to fixed weights, computed once.
+	 *					Assumes evenly spaced measurements, so with varying time steps the average over the window is used
+	 */
+	class BasicDifferentiator
+	{
+	public:
+		enum Method {LOW_PASS, SAVITZKY_GOLAY};
+
+		/**
+		 * Constructor
+		 * @param init_values			The starting values. Velocities and accelerations start at 0
+		 * @param time_step				The time between measurements, used when an update doesn't give one
+		 * @param method				How derivatives are estimated
+		 * @param filter_coefficient	LOW_PASS only. Higher = more smoothing, but also more lag in the data. Reccomended default = 2
+		 * @param window_size			SAVITZKY_GOLAY only. The number of measurements fit, higher = more smoothing
+		 * @param polynomial_order		SAVITZKY_GOLAY only. Less than window_size. Needs to be at least 2 for accelerations
+		 */
+		BasicDifferentiator(const std::vector<double>& init_values, double time_step, Method method=LOW_PASS,
+							double filter_coefficient=2.0, int window_size=7, int polynomial_order=2);
+
+		/**
+		 * Updates the estimates with new measurements
+		 * @param new_measurements	The new data, one value per channel
+		 * @param time_step			The time since the last measurement. If not positive, the constructor's time step is used
+		 */
+		void update(const std::vector<double>& new_measurements, double time_step=0.0);
+
+		/**
+		 * Updates the estimates with a new measurement of any type with valid conversion functions (e.g. a ROS message)
+		 * @param new_measurement	The new data. Must convert to one value per channel
+		 * @param time_step			The time since the last measurement. If not positive, the constructor's time step is used
+		 */
+		template <class T> void update(const T& new_measurement, double time_step=0.0);
+
+		/**
+		 * Updates the estimates with a new ROS message with a header (e.g. geometry_msgs::TwistStamped, sensor_msgs::JointState),
+		 * taking the time step from the header stamps. Each value is differentiated on its own, so quaternions are not handled
+		 * @param new_measurement	The new data. Must convert to one value per channel
+		 */
+		template <class T> void updateStamped(const T& new_measurement);
+
+		/**
+		 * Sets the values, with zero velocities and accelerations
+		 * @param reset_values	The values to reset to
+		 */
+		void reset(const std::vector<double>& reset_values);
+
+		/**
+		 * Gets the estimated velocity of each channel
+		 * @return		The velocities
+		 */
+		const std::vector<double>& getVelocity() const {return velocity_;};
+
+		/**
+		 * Gets the estimated acceleration of each channel
+		 * @return		The accelerations
+		 */
+		const std::vector<double>& getAcceleration() const {return acceleration_;};
+
+		/**
+		 * Gets the number of channels
+		 * @return		The number of values in each measurement
+		 */
+		size_t getNumberChannels() const {return num_channels_;};
+
+	private:
+		Method method_;
+		size_t num_channels_ = 0;
+		double nominal_time_step_ = 1.0;
+		std::vector<double> velocity_, acceleration_;
+		std::vector<double> scratch_;
+
+		// LOW_PASS state
+		double filter_coeff_ = 2.0;
+		std::vector<double> previous_measurement_, previous_raw_velocity_, previous_raw_acceleration_;
+
+		// SAVITZKY_GOLAY state. Measurements in ring buffer order, window_[slot*num_channels_ + channel]
+		size_t window_size_ = 1;
+		uint64_t time_ = 0;
+		std::vector<double> window_;
+		std::vector<double> time_steps_;			// The time step that came with each measurement in the window
+		double time_step_sum_ = 0.0;
+		std::vector<double> velocity_weights_;		// Indexed by age, 0 = newest, for a time step of 1
+		std::vector<double> acceleration_weights_;
+
+		double last_stamp_ = 0.0;
+		bool has_stamp_ = false;
+	};
+
+} //end nrg_tools namespace
@@ -0,0 +1,202 @@
+#pragma once
+
+/**
+ * Persisting the internal state of filters in a memory mapped file, so a restarted
+ * process can continue filtering where it left off instead of settling from a reset value
+ */
+
+#include "profiling.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nrg_tools{
+
+	/**
+	 * \class FilterSnapshot
+	 * A binary snapshot of a filter's state (e.g. a RosLowPassFilter or BasicLowPassMultiFilter) in a memory mapped file.
+	 * Saving only copies the state into the mapping, which the OS writes back to the file on its own, so it can be done
+	 * every cycle. The file survives the process crashing or being killed (not the machine losing power, unless flush()
+	 * is called). A save interrupted partway is detected, and the snapshot is then not restored
+	 */
+	class FilterSnapshot
+	{
+	public:
+		/**
+		 * Constructor. Maps the file, creating it if needed. An existing file for a different number of values
+		 * is started over. Throws an error if the file cannot be created or mapped
+		 * @param path			The file to keep the snapshot in (e.g. under /dev/shm to only keep it until a reboot)
+		 * @param num_values	The size of the filter state (e.g. RosLowPassFilter::getStateSize())
+		 */
+		FilterSnapshot(const std::string& path, size_t num_values);
+
+		~FilterSnapshot();
+
+		FilterSnapshot(const FilterSnapshot&) = delete;
+		FilterSnapshot& operator=(const FilterSnapshot&) = delete;
+
+		/**
+		 * Copies the state of a filter into the snapshot
+		 * @param filter	Anything with getStateSize() and getState(double*)
+		 * @return 			'false' if the filter state is not the size of the snapshot, 'true' otherwise
+		 */
+		template <class Filter> bool save(const Filter& filter);
+
+		/**
+		 * Sets the state of a filter from the snapshot
+		 * @param filter	Anything with getStateSize() and setState(const double*)
+		 * @param max_age	The oldest snapshot to restore, in seconds. Older snapshots are ignored
+		 * @return 			'true' if the filter was restored, 'false' if there is no complete snapshot of its size
+		 */
+		template <class Filter> bool restore(Filter& filter, double max_age=std::numeric_limits<double>::infinity()) const;
+
+		/**
+		 * Checks if the file holds a complete snapshot
+		 * @return		'true' if a save has finished, and none has started since
+		 */
+		bool hasState() const;
+
+		/**
+		 * Gets the time since the last save, which may be from before a restart
+		 * @return		The age in seconds, or infinity if there is no snapshot
+		 */
+		double getAge() const;
+
+		/**
+		 * Writes the mapping back to the file and waits for it. Too slow to call every cycle
+		 */
+		void flush();
+
+		size_t getNumberValues() const {return num_values_;};
+
+	private:
+		// Laid out at the start of the file
+		struct Header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t value_size;
+			uint64_t num_values;
+			uint64_t sequence;			// Odd while a save is in progress, 0 before the first save
+			int64_t stamp;				// Nanoseconds since the epoch of the last save
+		};
+
+		size_t num_values_;
+		size_t mapped_size_ = 0;
+		void* mapping_ = nullptr;
+		Header* header_ = nullptr;
+		double* values_ = nullptr;
+
+		static int64_t now()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		}
+	};
+
+	inline FilterSnapshot::FilterSnapshot(const std::string& path, size_t num_values) : num_values_(num_values)
+	{
+		static const char magic[8] = {'N', 'R', 'G', 'S', 'N', 'A', 'P', '\0'};
+		mapped_size_ = sizeof(Header) + num_values_ * sizeof(double);
+
+		const int file = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+		if(file < 0)
+		{
+			throw std::runtime_error("Could not open snapshot file " + path + ": " + std::strerror(errno));
+		}
+		struct stat status;
+		const bool matching_size = ::fstat(file, &status) == 0 && static_cast<size_t>(status.st_size) == mapped_size_;
+		if(!matching_size && ::ftruncate(file, mapped_size_) != 0)
+		{
+			::close(file);
+			throw std::runtime_error("Could not resize snapshot file " + path + ": " + std::strerror(errno));
+		}
+		mapping_ = ::mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		::close(file);
+		if(mapping_ == MAP_FAILED)
+		{
+			mapping_ = nullptr;
+			throw std::runtime_error("Could not map snapshot file " + path + ": " + std::strerror(errno));
+		}
+		header_ = static_cast<Header*>(mapping_);
+		values_ = reinterpret_cast<double*>(header_ + 1);
+
+		// Start over if the file is new or holds something else
+		if(!matching_size || std::memcmp(header_->magic, magic, sizeof(magic)) != 0 || header_->version != 1
+			|| header_->value_size != sizeof(double) || header_->num_values != num_values_)
+		{
+			std::memset(mapping_, 0, mapped_size_);
+			std::memcpy(header_->magic, magic, sizeof(magic));
+			header_->version = 1;
+			header_->value_size = sizeof(double);
+			header_->num_values = num_values_;
+		}
+	}
+
+	inline FilterSnapshot::~FilterSnapshot()
+	{
+		if(mapping_)
+		{
+			::munmap(mapping_, mapped_size_);
+		}
+	}
+
+	template <class Filter>
+	bool FilterSnapshot::save(const Filter& filter)
+	{
+		NRG_PROFILE_SCOPE("FilterSnapshot::save");
+		if(filter.getStateSize() != num_values_)
+		{
+			return false;
+		}
+		// The sequence is odd while the values are being written, so a save cut short by a crash is never restored
+		const uint64_t sequence = header_->sequence | 1;
+		header_->sequence = sequence;
+		std::atomic_thread_fence(std::memory_order_release);
+		filter.getState(values_);
+		header_->stamp = now();
+		std::atomic_thread_fence(std::memory_order_release);
+		header_->sequence = sequence + 1;
+		return true;
+	}
+
+	template <class Filter>
+	bool FilterSnapshot::restore(Filter& filter, double max_age) const
+	{
+		if(filter.getStateSize() != num_values_ || !hasState() || getAge() > max_age)
+		{
+			return false;
+		}
+		filter.setState(values_);
+		return true;
+	}
+
+	inline bool FilterSnapshot::hasState() const
+	{
+		const uint64_t sequence = header_->sequence;
+		return sequence != 0 && sequence % 2 == 0;
+	}
+
+	inline double FilterSnapshot::getAge() const
+	{
+		if(!hasState())
+		{
+			return std::numeric_limits<double>::infinity();
+		}
+		return 1e-9 * (now() - header_->stamp);
+	}
+
+	inline void FilterSnapshot::flush()
+	{
+		::msync(mapping_, mapped_size_, MS_SYNC);
+	}
+
+} // end nrg_tools namespace
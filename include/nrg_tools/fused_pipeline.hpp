@@ -0,0 +1,287 @@
+#pragma once
+
+/**
+ * A per-message processing chain (convert -> filter -> scale -> bound -> convert) that is set up once
+ * and then runs in a single pass over the data, without the temporary vectors of calling
+ * the stages one by one
+ */
+
+#include "controller_tools.hpp"
+#include "basic_lowpass_filters.cpp"
+#include <cmath>
+#include <stdexcept>
+
+namespace nrg_tools{
+
+	/**
+	 * \class FusedPipeline
+	 * Runs a list of element-wise stages on the values of an input type and writes the result
+	 * to an output type (e.g. geometry_msgs::Wrench in, geometry_msgs::Twist out). Any types
+	 * with valid conversion functions and the same number of elements can be used.
+	 *
+	 * Stages are added in order with lowPass(), scale(), and bound(), and boundUniform() can optionally end
+	 * the chain. Each call to run() converts the input once into the pipeline's working data, takes each element
+	 * through every stage in a single pass, and converts once into the output. The working data and all
+	 * stage parameters are stored when the pipeline is built, so run() does not allocate for fixed size types
+	 * (e.g. geometry_msgs), which are converted through the stack
+	 */
+	template<class In, class Out=In>
+	class FusedPipeline
+	{
+	public:
+		/**
+		 * Constructor
+		 * @param init_value	The starting value of the pipeline's filters, in the input type
+		 */
+		FusedPipeline(const In& init_value);
+
+		/**
+		 * Adds a low pass filter stage, same as BasicLowPassFilter
+		 * @param filter_coefficients	Higher = more smoothing, but also more lag in the data, element-wise on the input.
+		 *								Can be any type with the same number of elements
+		 * @return 						This pipeline, for chaining stages
+		 */
+		template<class U> FusedPipeline& lowPass(const U& filter_coefficients);
+
+		/**
+		 * Adds a stage that multiplies each element by a gain
+		 * @param gains		The gains, element-wise on the input
+		 * @return 			This pipeline, for chaining stages
+		 */
+		template<class U> FusedPipeline& scale(const U& gains);
+
+		/**
+		 * Adds a stage that restricts each element to its bounds, same as boundAll()
+		 * @param lower 	The lower limits, element-wise on the input
+		 * @param upper 	The upper limits, element-wise on the input
+		 * @return 			This pipeline, for chaining stages
+		 */
+		template<class U> FusedPipeline& bound(const U& lower, const U& upper);
+
+		/**
+		 * Ends the pipeline by uniformly scaling all elements until they are within their limits, same as boundUniform().
+		 * No stages can be added after this one
+		 * @param limit 	The (plus and minus) limit, element-wise on the input
+		 * @return 			This pipeline
+		 */
+		template<class U> FusedPipeline& boundUniform(const U& limit);
+
+		/**
+		 * Runs every stage on a new input
+		 * @param input		The new data, must have the same number of elements as the init value
+		 * @param output	The processed data. Fields that are not converted (e.g. headers) are left unchanged
+		 * @return 			'true' if the output conversion was successful, 'false' otherwise
+		 */
+		bool run(const In& input, Out& output);
+
+		/**
+		 * Sets all of the pipeline's filters as if the input had always been this value
+		 * @param reset_value	The value to reset to, in the input type
+		 */
+		void reset(const In& reset_value);
+
+		/**
+		 * Gets the number of elements the pipeline processes
+		 * @return		The number of elements
+		 */
+		size_t getNumberElements() const {return num_elements_;};
+
+	private:
+		enum StageType {LOW_PASS, SCALE, BOUND};
+		struct Stage
+		{
+			StageType type;
+			size_t offset;		// Start of this stage's parameters in filters_ or params_
+		};
+
+		size_t num_elements_ = 0;
+		std::vector<Stage> stages_;
+		std::vector<BasicLowPassFilter> filters_;
+		std::vector<double> params_;			// Gains, or lower then upper bounds, num_elements_ values each
+		std::vector<double> uniform_limits_;	// Empty if there is no boundUniform() stage
+		std::vector<double> reset_values_;		// The init (or last reset) value, for filters added later
+		std::vector<double> work_;
+
+		/**
+		 * Converts a stage parameter and checks it has one value per element
+		 */
+		template<class U> void toParameter(const U& value, std::vector<double>& output) const;
+
+		/**
+		 * Runs one element through every stage
+		 */
+		double runElement(const size_t element, double value);
+
+		/**
+		 * Initializes the low pass filter for an element of a stage, from the value at the start of the pipeline
+		 */
+		void resetElement(const size_t stage, const size_t element, const double value);
+	};
+
+	template<class In, class Out>
+	FusedPipeline<In, Out>::FusedPipeline(const In& init_value)
+	{
+		convert(init_value, reset_values_);
+		num_elements_ = reset_values_.size();
+		work_.resize(num_elements_);
+	}
+
+	template<class In, class Out> template<class U>
+	FusedPipeline<In, Out>& FusedPipeline<In, Out>::lowPass(const U& filter_coefficients)
+	{
+		std::vector<double> coefficients;
+		toParameter(filter_coefficients, coefficients);
+		Stage stage = {LOW_PASS, filters_.size()};
+		for(size_t i=0; i<num_elements_; ++i)
+		{
+			filters_.push_back(BasicLowPassFilter(coefficients[i]));
+		}
+		stages_.push_back(stage);
+
+		// Start from the init (or last reset) value as seen by this stage
+		for(size_t i=0; i<num_elements_; ++i)
+		{
+			resetElement(stages_.size() - 1, i, reset_values_[i]);
+		}
+		return *this;
+	}
+
+	template<class In, class Out> template<class U>
+	FusedPipeline<In, Out>& FusedPipeline<In, Out>::scale(const U& gains)
+	{
+		std::vector<double> gain_vector;
+		toParameter(gains, gain_vector);
+		Stage stage = {SCALE, params_.size()};
+		params_.insert(params_.end(), gain_vector.begin(), gain_vector.end());
+		stages_.push_back(stage);
+		return *this;
+	}
+
+	template<class In, class Out> template<class U>
+	FusedPipeline<In, Out>& FusedPipeline<In, Out>::bound(const U& lower, const U& upper)
+	{
+		std::vector<double> lower_vector, upper_vector;
+		toParameter(lower, lower_vector);
+		toParameter(upper, upper_vector);
+		Stage stage = {BOUND, params_.size()};
+		params_.insert(params_.end(), lower_vector.begin(), lower_vector.end());
+		params_.insert(params_.end(), upper_vector.begin(), upper_vector.end());
+		stages_.push_back(stage);
+		return *this;
+	}
+
+	template<class In, class Out> template<class U>
+	FusedPipeline<In, Out>& FusedPipeline<In, Out>::boundUniform(const U& limit)
+	{
+		toParameter(limit, uniform_limits_);
+		return *this;
+	}
+
+	template<class In, class Out>
+	bool FusedPipeline<In, Out>::run(const In& input, Out& output)
+	{
+		NRG_PROFILE_SCOPE("FusedPipeline::run");
+		// work_ keeps its capacity, so this only copies into it
+		convert(input, work_);
+		if(work_.size() != num_elements_)
+		{
+			throw std::invalid_argument("Input size does not match the pipeline");
+		}
+
+		// Every stage runs on an element before moving to the next one, so the data is only walked once.
+		// Only the uniform bound needs a second pass, since it depends on all of the elements
+		double min_multiplier = 1;
+		const bool uniform = !uniform_limits_.empty();
+		for(size_t i=0; i<num_elements_; ++i)
+		{
+			work_[i] = runElement(i, work_[i]);
+			if(uniform && fabs(work_[i]) > fabs(uniform_limits_[i]))
+			{
+				min_multiplier = std::min(min_multiplier, fabs(uniform_limits_[i]) / fabs(work_[i]));
+			}
+		}
+		if(min_multiplier < 1)
+		{
+			for(size_t i=0; i<num_elements_; ++i)
+			{
+				work_[i] *= min_multiplier;
+			}
+		}
+		return nrg_conversions::fromVec(work_, output);
+	}
+
+	template<class In, class Out>
+	void FusedPipeline<In, Out>::reset(const In& reset_value)
+	{
+		std::vector<double> reset_vector;
+		convert(reset_value, reset_vector);
+		if(reset_vector.size() != num_elements_)
+		{
+			throw std::invalid_argument("Reset value size does not match the pipeline");
+		}
+		reset_values_ = reset_vector;
+		for(size_t s=0; s<stages_.size(); ++s)
+		{
+			if(stages_[s].type != LOW_PASS) continue;
+			for(size_t i=0; i<num_elements_; ++i)
+			{
+				resetElement(s, i, reset_values_[i]);
+			}
+		}
+	}
+
+	template<class In, class Out> template<class U>
+	void FusedPipeline<In, Out>::toParameter(const U& value, std::vector<double>& output) const
+	{
+		if(!uniform_limits_.empty())
+		{
+			throw std::logic_error("No stages can be added after boundUniform()");
+		}
+		convert(value, output);
+		if(output.size() != num_elements_)
+		{
+			throw std::invalid_argument("Stage parameter size does not match the pipeline");
+		}
+	}
+
+	template<class In, class Out>
+	double FusedPipeline<In, Out>::runElement(const size_t element, double value)
+	{
+		// The stages are a flat table of types and parameter offsets, built once with the pipeline
+		BasicLowPassFilter* filters = filters_.data() + element;
+		const double* params = params_.data() + element;
+		for(size_t s=0; s<stages_.size(); ++s)
+		{
+			const Stage& stage = stages_[s];
+			switch(stage.type)
+			{
+				case LOW_PASS:
+					value = filters[stage.offset].filter(value);
+					break;
+				case SCALE:
+					value *= params[stage.offset];
+					break;
+				case BOUND:
+					value = nrg_tools::bound(value, params[stage.offset], params[stage.offset + num_elements_]);
+					break;
+			}
+		}
+		return value;
+	}
+
+	template<class In, class Out>
+	void FusedPipeline<In, Out>::resetElement(const size_t stage, const size_t element, const double value)
+	{
+		// Earlier filters are already reset to this value, so they pass it straight through
+		BasicLowPassFilter& filter = filters_[stages_[stage].offset + element];
+		double stage_input = value;
+		for(size_t s=0; s<stage; ++s)
+		{
+			const Stage& previous = stages_[s];
+			if(previous.type == SCALE) stage_input *= params_[previous.offset + element];
+			else if(previous.type == BOUND) stage_input = nrg_tools::bound(stage_input, params_[previous.offset + element], params_[previous.offset + num_elements_ + element]);
+		}
+		filter.reset(stage_input);
+	}
+
+} // end nrg_tools namespace
@@ -0,0 +1,203 @@
+#pragma once
+
+/**
+ * Low pass filtering of topics whose message type is only known at runtime.
+ * A registry holds one filter plan per supported message type; the plan is picked once
+ * when the first message arrives, after which messages go straight to the typed filter
+ */
+
+#include <ros/ros.h>
+#include <topic_tools/shape_shifter.h>
+#include <map>
+#include <memory>
+#include <ros_lowpass_filter.cpp>
+
+namespace nrg_tools{
+
+	/**
+	 * \class GenericFilterPlan
+	 * Filters and republishes serialized messages of a single type
+	 */
+	class GenericFilterPlan
+	{
+	public:
+		virtual ~GenericFilterPlan(){};
+
+		/**
+		 * Deserializes, filters and republishes a message. The message must be of the type the plan was made for
+		 * @param message	The serialized message
+		 */
+		virtual void filter(const topic_tools::ShapeShifter& message) = 0;
+	};
+
+	/**
+	 * \class TypedFilterPlan
+	 * A GenericFilterPlan for message type T, using a RosLowPassFilter<T>.
+	 * The deserialization buffer and message are reused between messages
+	 */
+	template <class T> class TypedFilterPlan : public GenericFilterPlan
+	{
+	public:
+		/**
+		 * Constructor. The filter starts at the value of the first message
+		 * @param first_message			The first message received, used to size and initialize the filter
+		 * @param filter_coefficient	The coefficient used for every element of the message
+		 * @param nh					The node handle to advertise the output on
+		 * @param output_topic			The topic to publish the filtered messages on
+		 */
+		TypedFilterPlan(const topic_tools::ShapeShifter& first_message, double filter_coefficient,
+		                ros::NodeHandle& nh, const std::string& output_topic);
+
+		void filter(const topic_tools::ShapeShifter& message);
+
+	private:
+		std::vector<uint8_t> buffer_;
+		T message_;
+		std::unique_ptr<RosLowPassFilter<T> > filter_;
+		ros::Publisher publisher_;
+
+		/**
+		 * Deserializes the message into message_
+		 */
+		void deserialize(const topic_tools::ShapeShifter& message);
+	};
+
+	template <class T> TypedFilterPlan<T>::TypedFilterPlan(const topic_tools::ShapeShifter& first_message, double filter_coefficient,
+	                                                       ros::NodeHandle& nh, const std::string& output_topic)
+	{
+		deserialize(first_message);
+
+		// Start from the message itself so fields that are not filtered (e.g. joint names) are kept
+		std::vector<double> coeff_vector;
+		convert(message_, coeff_vector);
+		coeff_vector.assign(coeff_vector.size(), filter_coefficient);
+		T coeffs = message_;
+		convert(coeff_vector, coeffs);
+
+		filter_.reset(new RosLowPassFilter<T>(coeffs));
+		filter_->reset(message_);
+		publisher_ = nh.advertise<T>(output_topic, 10);
+	}
+
+	template <class T> void TypedFilterPlan<T>::filter(const topic_tools::ShapeShifter& message)
+	{
+		deserialize(message);
+		publisher_.publish(filter_->filter(message_));
+	}
+
+	template <class T> void TypedFilterPlan<T>::deserialize(const topic_tools::ShapeShifter& message)
+	{
+		// Goes through the raw bytes rather than ShapeShifter::instantiate(), which checks the type every time
+		buffer_.resize(message.size());
+		ros::serialization::OStream ostream(buffer_.data(), buffer_.size());
+		message.write(ostream);
+		ros::serialization::IStream istream(buffer_.data(), buffer_.size());
+		ros::serialization::deserialize(istream, message_);
+	}
+
+	/**
+	 * \class GenericFilterRegistry
+	 * Creates filter plans from the data type of a message. By default the geometry_msgs types that convert()
+	 * supports and sensor_msgs::JointState are registered. Polygon, PolygonStamped and PointCloud2 are not,
+	 * since their number of values can change from one message to the next, which the filter does not allow
+	 */
+	class GenericFilterRegistry
+	{
+	public:
+		typedef GenericFilterPlan* (*Factory)(const topic_tools::ShapeShifter&, double, ros::NodeHandle&, const std::string&);
+
+		/**
+		 * Constructor, registers all of the default types
+		 */
+		GenericFilterRegistry();
+
+		/**
+		 * Registers a message type. It must have valid conversion functions
+		 */
+		template <class T> void add();
+
+		/**
+		 * Creates the filter plan for the type of a message
+		 * @param first_message			The first message received on the topic
+		 * @param filter_coefficient	The coefficient used for every element of the message
+		 * @param nh					The node handle to advertise the output on
+		 * @param output_topic			The topic to publish the filtered messages on
+		 * @return						The new plan, or NULL if the type is not supported. The caller owns the plan
+		 */
+		GenericFilterPlan* create(const topic_tools::ShapeShifter& first_message, double filter_coefficient,
+		                          ros::NodeHandle& nh, const std::string& output_topic) const;
+
+		/**
+		 * Gets the data types that plans can be made for
+		 * @return		The ROS data type names, e.g. "geometry_msgs/Wrench"
+		 */
+		std::vector<std::string> getSupportedTypes() const;
+
+	private:
+		struct Entry
+		{
+			std::string md5sum;
+			Factory factory;
+		};
+		std::map<std::string, Entry> entries_;
+
+		template <class T> static GenericFilterPlan* makePlan(const topic_tools::ShapeShifter& first_message, double filter_coefficient,
+		                                                      ros::NodeHandle& nh, const std::string& output_topic)
+		{
+			return new TypedFilterPlan<T>(first_message, filter_coefficient, nh, output_topic);
+		}
+	};
+
+	inline GenericFilterRegistry::GenericFilterRegistry()
+	{
+		add<geometry_msgs::Accel>();
+		add<geometry_msgs::AccelStamped>();
+		add<geometry_msgs::Point>();
+		add<geometry_msgs::Point32>();
+		add<geometry_msgs::PointStamped>();
+		add<geometry_msgs::Pose>();
+		add<geometry_msgs::Pose2D>();
+		add<geometry_msgs::PoseStamped>();
+		add<geometry_msgs::Quaternion>();
+		add<geometry_msgs::QuaternionStamped>();
+		add<geometry_msgs::Transform>();
+		add<geometry_msgs::TransformStamped>();
+		add<geometry_msgs::Twist>();
+		add<geometry_msgs::TwistStamped>();
+		add<geometry_msgs::Vector3>();
+		add<geometry_msgs::Vector3Stamped>();
+		add<geometry_msgs::Wrench>();
+		add<geometry_msgs::WrenchStamped>();
+		add<sensor_msgs::JointState>();
+	}
+
+	template <class T> void GenericFilterRegistry::add()
+	{
+		Entry entry;
+		entry.md5sum = ros::message_traits::MD5Sum<T>::value();
+		entry.factory = &GenericFilterRegistry::makePlan<T>;
+		entries_[ros::message_traits::DataType<T>::value()] = entry;
+	}
+
+	inline GenericFilterPlan* GenericFilterRegistry::create(const topic_tools::ShapeShifter& first_message, double filter_coefficient,
+	                                                        ros::NodeHandle& nh, const std::string& output_topic) const
+	{
+		std::map<std::string, Entry>::const_iterator it = entries_.find(first_message.getDataType());
+		if(it == entries_.end() || it->second.md5sum != first_message.getMD5Sum())
+		{
+			return NULL;
+		}
+		return it->second.factory(first_message, filter_coefficient, nh, output_topic);
+	}
+
+	inline std::vector<std::string> GenericFilterRegistry::getSupportedTypes() const
+	{
+		std::vector<std::string> output;
+		for(std::map<std::string, Entry>::const_iterator it=entries_.begin(); it!=entries_.end(); ++it)
+		{
+			output.push_back(it->first);
+		}
+		return output;
+	}
+
+} // end nrg_tools namespace
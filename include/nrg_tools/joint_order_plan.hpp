@@ -0,0 +1,198 @@
+#pragma once
+
+/**
+ * Reordering of joint data from messages whose joint order is not fixed (e.g. sensor_msgs::JointState
+ * from different drivers) into a fixed order, without any name lookups per message
+ */
+
+#include "conversions.hpp"
+#include <string>
+#include <unordered_map>
+
+namespace nrg_tools{
+
+	/**
+	 * \class JointOrderPlan
+	 * Maps the joint order of incoming messages onto a desired joint order.
+	 * The index mapping is only rebuilt when the message's joint names change. Every name is compared exactly,
+	 * since joints like "wrist_1_joint" and "wrist_2_joint" only differ in the middle. Unchanged names only
+	 * cost a length check and a memcmp each, so per message there are no lookups or allocations, just an indexed copy
+	 */
+	class JointOrderPlan
+	{
+	public:
+		/**
+		 * Constructor
+		 * @param joint_names		The joints to extract, in the order they should be output
+		 */
+		JointOrderPlan(const std::vector<std::string>& joint_names);
+
+		/**
+		 * Makes sure the plan matches the joint names of an incoming message, rebuilding it if they changed
+		 * @param message_names		The joint names of the message (e.g. JointState::name)
+		 * @return 					'true' if every desired joint is in the message, 'false' otherwise
+		 */
+		bool update(const std::vector<std::string>& message_names);
+
+		/**
+		 * Copies one field of message data (e.g. JointState::position) into the desired joint order
+		 * @param input		The message data, in the order of the names given to update()
+		 * @param output	The reordered data. Must already be sized to the number of joints
+		 * @return 			'true' if the plan is valid and all sizes match, 'false' otherwise
+		 */
+		bool gather(const std::vector<double>& input, Eigen::Ref<Eigen::VectorXd> output) const;
+
+		/**
+		 * Copies data in the desired joint order back into message order. Message joints
+		 * that are not part of the plan are left unchanged
+		 * @param input		The data in the desired joint order
+		 * @param output	The message data. Resized to the number of message joints if needed
+		 * @return 			'true' if the plan is valid and the input size matches, 'false' otherwise
+		 */
+		bool scatter(const Eigen::Ref<const Eigen::VectorXd>& input, std::vector<double>& output) const;
+
+		/**
+		 * Checks if the last call to update() found all of the desired joints
+		 * @return		'true' if the plan can be used
+		 */
+		bool isValid() const {return valid_;};
+
+		/**
+		 * Gets the number of joints the plan outputs
+		 * @return		The number of joints
+		 */
+		size_t getNumberJoints() const {return joint_names_.size();};
+
+		/**
+		 * Gets the desired joint order
+		 * @return		The joint names given to the constructor
+		 */
+		const std::vector<std::string>& getJointNames() const {return joint_names_;};
+
+	private:
+		std::vector<std::string> joint_names_;
+		std::vector<std::string> message_names_;
+		std::vector<size_t> indices_;
+		bool valid_ = false;
+	};
+
+	inline JointOrderPlan::JointOrderPlan(const std::vector<std::string>& joint_names)
+	{
+		joint_names_ = joint_names;
+		indices_.assign(joint_names_.size(), 0);
+	}
+
+	inline bool JointOrderPlan::update(const std::vector<std::string>& message_names)
+	{
+		if(message_names == message_names_)
+		{
+			return valid_;
+		}
+
+		// The names changed, so build the mapping again
+		message_names_ = message_names;
+		std::unordered_map<std::string, size_t> lookup;
+		for(size_t i=0; i<message_names_.size(); ++i)
+		{
+			lookup[message_names_[i]] = i;
+		}
+
+		valid_ = true;
+		for(size_t i=0; i<joint_names_.size(); ++i)
+		{
+			std::unordered_map<std::string, size_t>::const_iterator it = lookup.find(joint_names_[i]);
+			if(it == lookup.end())
+			{
+				valid_ = false;
+				break;
+			}
+			indices_[i] = it->second;
+		}
+		return valid_;
+	}
+
+	inline bool JointOrderPlan::gather(const std::vector<double>& input, Eigen::Ref<Eigen::VectorXd> output) const
+	{
+		if(!valid_ || input.size() != message_names_.size() || static_cast<size_t>(output.size()) != indices_.size()) return false;
+		for(size_t i=0; i<indices_.size(); ++i)
+		{
+			output[i] = input[indices_[i]];
+		}
+		return true;
+	}
+
+	inline bool JointOrderPlan::scatter(const Eigen::Ref<const Eigen::VectorXd>& input, std::vector<double>& output) const
+	{
+		if(!valid_ || static_cast<size_t>(input.size()) != indices_.size()) return false;
+		output.resize(message_names_.size(), 0.0);
+		for(size_t i=0; i<indices_.size(); ++i)
+		{
+			output[indices_[i]] = input[i];
+		}
+		return true;
+	}
+
+	/**
+	 * Converts a sensor_msgs::JointState into the joint order of a plan. The output holds
+	 * the positions, then the velocities, then the efforts, skipping fields that are empty in the message.
+	 * This is the same layout as convert(), but reordered
+	 * @param input		The joint state message
+	 * @param output	The reordered data. Only reallocated if its size changes
+	 * @param plan		The joint order plan, updated from the message names if needed
+	 * @return 			Returns 'true' if the conversion was successful, 'false' otherwise
+	 */
+	inline bool convert(const sensor_msgs::JointState& input, Eigen::VectorXd& output, JointOrderPlan& plan)
+	{
+		if(!plan.update(input.name)) return false;
+		const std::vector<double>* fields[3] = {&input.position, &input.velocity, &input.effort};
+		const size_t num_joints = plan.getNumberJoints();
+
+		size_t num_fields = 0;
+		for(size_t i=0; i<3; ++i)
+		{
+			if(!fields[i]->empty()) ++num_fields;
+		}
+		output.resize(num_fields * num_joints);
+
+		size_t start = 0;
+		for(size_t i=0; i<3; ++i)
+		{
+			if(fields[i]->empty()) continue;
+			if(!plan.gather(*fields[i], output.segment(start, num_joints))) return false;
+			start += num_joints;
+		}
+		return true;
+	}
+
+	/**
+	 * Converts a trajectory_msgs::JointTrajectoryPoint into the joint order of a plan. The output holds
+	 * the positions, then the velocities, then the accelerations, then the efforts, skipping empty fields.
+	 * Points have no names, so the plan must be updated with the trajectory's joint_names beforehand
+	 * @param input		The trajectory point
+	 * @param output	The reordered data. Only reallocated if its size changes
+	 * @param plan		The joint order plan
+	 * @return 			Returns 'true' if the conversion was successful, 'false' otherwise
+	 */
+	inline bool convert(const trajectory_msgs::JointTrajectoryPoint& input, Eigen::VectorXd& output, const JointOrderPlan& plan)
+	{
+		const std::vector<double>* fields[4] = {&input.positions, &input.velocities, &input.accelerations, &input.effort};
+		const size_t num_joints = plan.getNumberJoints();
+
+		size_t num_fields = 0;
+		for(size_t i=0; i<4; ++i)
+		{
+			if(!fields[i]->empty()) ++num_fields;
+		}
+		output.resize(num_fields * num_joints);
+
+		size_t start = 0;
+		for(size_t i=0; i<4; ++i)
+		{
+			if(fields[i]->empty()) continue;
+			if(!plan.gather(*fields[i], output.segment(start, num_joints))) return false;
+			start += num_joints;
+		}
+		return true;
+	}
+
+} // end nrg_tools namespace
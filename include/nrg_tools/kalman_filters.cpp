@@ -0,0 +1,207 @@
+#pragma once
+
+#include <kalman_filters.h>
+#include <profiling.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+using namespace nrg_tools;
+
+template<int Order>
+BasicKalmanMultiFilter<Order>::BasicKalmanMultiFilter(double time_step, const std::vector<double>& process_noise,
+													  const std::vector<double>& measurement_noise,
+													  const std::vector<double>& init_values, bool steady_state)
+{
+	num_filters_ = init_values.size();
+	if(process_noise.size() != num_filters_ || measurement_noise.size() != num_filters_)
+	{
+		throw std::out_of_range("Noise vectors must be same size as the number of filters");
+	}
+	if(time_step <= 0)
+	{
+		throw std::invalid_argument("Time step must be positive");
+	}
+	// With no process noise the steady-state gains are 0, and the iteration only creeps towards them
+	if(steady_state && !process_noise.empty() && *std::min_element(process_noise.begin(), process_noise.end()) <= 0)
+	{
+		throw std::invalid_argument("Process noise must be positive for steady-state gains");
+	}
+	steady_state_ = steady_state;
+	process_noise_ = Eigen::Map<const Eigen::ArrayXd>(process_noise.data(), num_filters_);
+	measurement_noise_ = Eigen::Map<const Eigen::ArrayXd>(measurement_noise.data(), num_filters_);
+
+	// Integrating white noise in the highest derivative over one time step
+	double factorial[2*Order] = {1};
+	for(int i=1; i<2*Order; ++i) factorial[i] = factorial[i-1] * i;
+	for(int i=0; i<Order; ++i)
+	{
+		for(int j=0; j<Order; ++j)
+		{
+			transition_[i][j] = (j >= i) ? std::pow(time_step, j-i) / factorial[j-i] : 0.0;
+			const int power = 2*Order - 1 - i - j;
+			unit_process_noise_[i][j] = std::pow(time_step, power) / (factorial[Order-1-i] * factorial[Order-1-j] * power);
+		}
+	}
+
+	// Size every array once, so updates never allocate
+	for(int i=0; i<Order; ++i)
+	{
+		state_[i].setZero(num_filters_);
+		gains_[i].setZero(num_filters_);
+		row_[i].setZero(num_filters_);
+		for(int j=0; j<Order; ++j)
+		{
+			covariance_[i][j].setZero(num_filters_);
+			scratch_[i][j].setZero(num_filters_);
+		}
+	}
+	innovation_.setZero(num_filters_);
+	innovation_variance_.setZero(num_filters_);
+	reset(init_values);
+
+	if(steady_state_)
+	{
+		// Iterate the covariance until the gains stop changing. The value gains are between 0 and 1,
+		// so small gains also stop at an absolute tolerance instead of a relative one.
+		// The innovation is not used yet, so it holds the previous gains
+		resetCovariance();
+		for(int iteration=0; iteration<100000; ++iteration)
+		{
+			innovation_ = gains_[0];
+			predictCovariance();
+			updateCovariance();
+			if(iteration > 0 && ((gains_[0] - innovation_).abs() <= 1e-12 * gains_[0].abs() + 1e-15).all()) break;
+		}
+	}
+}
+
+template<int Order>
+void BasicKalmanMultiFilter<Order>::update(const std::vector<double>& new_measurements)
+{
+	NRG_PROFILE_SCOPE("BasicKalmanMultiFilter::update");
+	if(new_measurements.size() != num_filters_)
+	{
+		throw std::out_of_range("New Measurement vector must be same size as the number of filters");
+	}
+	predict();
+	if(!steady_state_)
+	{
+		predictCovariance();
+		updateCovariance();
+	}
+	innovation_ = Eigen::Map<const Eigen::ArrayXd>(new_measurements.data(), num_filters_) - state_[0];
+	for(int i=0; i<Order; ++i)
+	{
+		state_[i] += gains_[i] * innovation_;
+	}
+}
+
+template<int Order>
+std::vector<double> BasicKalmanMultiFilter<Order>::filter(const std::vector<double>& new_measurements)
+{
+	update(new_measurements);
+	return std::vector<double>(state_[0].data(), state_[0].data() + num_filters_);
+}
+
+template<int Order>
+void BasicKalmanMultiFilter<Order>::getState(const int derivative, std::vector<double>& output) const
+{
+	if(derivative < 0 || derivative >= Order)
+	{
+		throw std::out_of_range("Derivative is not part of the model");
+	}
+	output.assign(state_[derivative].data(), state_[derivative].data() + num_filters_);
+}
+
+template<int Order>
+void BasicKalmanMultiFilter<Order>::reset(const std::vector<double>& reset_values)
+{
+	if(reset_values.size() != num_filters_)
+	{
+		throw std::out_of_range("Reset Values vector must be same size as the number of filters");
+	}
+	state_[0] = Eigen::Map<const Eigen::ArrayXd>(reset_values.data(), num_filters_);
+	for(int i=1; i<Order; ++i)
+	{
+		state_[i].setZero();
+	}
+	// Steady-state gains don't depend on the starting covariance, so they are kept
+	if(!steady_state_)
+	{
+		resetCovariance();
+	}
+}
+
+template<int Order>
+void BasicKalmanMultiFilter<Order>::predict()
+{
+	// The transition is upper triangular, so the state can be moved forward in place
+	for(int i=0; i<Order; ++i)
+	{
+		for(int j=i+1; j<Order; ++j)
+		{
+			state_[i] += transition_[i][j] * state_[j];
+		}
+	}
+}
+
+template<int Order>
+void BasicKalmanMultiFilter<Order>::predictCovariance()
+{
+	// covariance = F * covariance * F' + Q
+	for(int i=0; i<Order; ++i)
+	{
+		for(int j=0; j<Order; ++j)
+		{
+			scratch_[i][j] = covariance_[i][j];
+			for(int k=i+1; k<Order; ++k)
+			{
+				scratch_[i][j] += transition_[i][k] * covariance_[k][j];
+			}
+		}
+	}
+	for(int i=0; i<Order; ++i)
+	{
+		for(int j=0; j<Order; ++j)
+		{
+			covariance_[i][j] = scratch_[i][j] + unit_process_noise_[i][j] * process_noise_;
+			for(int k=j+1; k<Order; ++k)
+			{
+				covariance_[i][j] += scratch_[i][k] * transition_[j][k];
+			}
+		}
+	}
+}
+
+template<int Order>
+void BasicKalmanMultiFilter<Order>::updateCovariance()
+{
+	// Only the value is measured, so the gains are the first column of the covariance over the innovation variance
+	innovation_variance_ = covariance_[0][0] + measurement_noise_;
+	for(int i=0; i<Order; ++i)
+	{
+		gains_[i] = covariance_[i][0] / innovation_variance_;
+		row_[i] = covariance_[0][i];
+	}
+	for(int i=0; i<Order; ++i)
+	{
+		for(int j=0; j<Order; ++j)
+		{
+			covariance_[i][j] -= gains_[i] * row_[j];
+		}
+	}
+}
+
+template<int Order>
+void BasicKalmanMultiFilter<Order>::resetCovariance()
+{
+	// Roughly the uncertainty of finite differencing the measurements
+	for(int i=0; i<Order; ++i)
+	{
+		for(int j=0; j<Order; ++j)
+		{
+			covariance_[i][j].setZero();
+		}
+		covariance_[i][i] = measurement_noise_ * std::pow(transition_[0][1], -2*i);
+	}
+}
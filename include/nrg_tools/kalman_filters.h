@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <Eigen/Eigen>
+
+namespace nrg_tools{
+	/**
+	 * \class BasicKalmanMultiFilter
+	 * A bank of Kalman filters that estimate the value and its derivatives from noisy measurements of a vector
+	 * of values (channels), with no ROS capabilities. Each channel is modelled separately, with a constant
+	 * velocity (Order = 2) or constant acceleration (Order = 3) model driven by white noise in the highest derivative.
+	 * The model size is fixed at compile time and every entry of the state and covariance is stored as an array
+	 * over the channels, so one update works through all channels at once without allocating.
+	 * With steady-state gains the covariance is solved once at construction, and each update only applies the gains
+	 */
+	template<int Order>
+	class BasicKalmanMultiFilter
+	{
+		static_assert(Order == 2 || Order == 3, "Only constant velocity (2) and constant acceleration (3) models are supported");
+
+	public:
+		/**
+		 * Constructor
+		 * @param time_step				The time between measurements
+		 * @param process_noise			Per channel, the spectral density of the noise driving the highest derivative.
+		 *								Higher = follows changes faster, but smooths less. Must be positive with steady-state gains
+		 * @param measurement_noise		Per channel, the variance of the measurements
+		 * @param init_values			The starting values of the filter. Derivatives start at 0
+		 * @param steady_state			If 'true', use fixed gains, computed once, instead of updating the covariance
+		 */
+		BasicKalmanMultiFilter(double time_step, const std::vector<double>& process_noise, const std::vector<double>& measurement_noise,
+							   const std::vector<double>& init_values, bool steady_state=false);
+
+		/**
+		 * Updates the filters with the new measurements
+		 * @param new_measurements	The new data to be filtered
+		 */
+		void update(const std::vector<double>& new_measurements);
+
+		/**
+		 * Updates the filters with the new measurements and returns the filtered data as a vector
+		 * @param new_measurements	The new data to be filtered
+		 * @return 					The estimated values after accounting for the newest data
+		 */
+		std::vector<double> filter(const std::vector<double>& new_measurements);
+
+		/**
+		 * Gets one part of the estimated state
+		 * @param derivative	0 for the values, 1 for the velocities, 2 for the accelerations (Order = 3 only)
+		 * @param output		The estimates, one per channel. Resized if needed
+		 */
+		void getState(const int derivative, std::vector<double>& output) const;
+
+		/**
+		 * Sets all of the filters to the desired values, with zero derivatives and the initial covariance
+		 * @param reset_values	The values to set the filters to
+		 */
+		void reset(const std::vector<double>& reset_values);
+
+		/**
+		 * Gets the number of filters this multi filter is tracking
+		 * @return		The number of filters
+		 */
+		size_t getNumberFilters() const {return num_filters_;};
+
+	private:
+		size_t num_filters_ = 0;
+		bool steady_state_ = false;
+		double transition_[Order][Order];			// State transition over one time step
+		double unit_process_noise_[Order][Order];	// Process noise covariance for a spectral density of 1
+
+		// Each entry is an array over the channels
+		Eigen::ArrayXd state_[Order];
+		Eigen::ArrayXd covariance_[Order][Order];
+		Eigen::ArrayXd gains_[Order];
+		Eigen::ArrayXd process_noise_, measurement_noise_;
+		Eigen::ArrayXd scratch_[Order][Order], row_[Order], innovation_, innovation_variance_;
+
+		/**
+		 * Moves the state forward one time step
+		 */
+		void predict();
+
+		/**
+		 * Moves the covariance forward one time step
+		 */
+		void predictCovariance();
+
+		/**
+		 * Computes the gains, and updates the covariance with a measurement
+		 */
+		void updateCovariance();
+
+		/**
+		 * Sets the covariance to its starting value
+		 */
+		void resetCovariance();
+	};
+
+	typedef BasicKalmanMultiFilter<2> BasicConstantVelocityFilter;
+	typedef BasicKalmanMultiFilter<3> BasicConstantAccelerationFilter;
+
+} //end nrg_tools namespace
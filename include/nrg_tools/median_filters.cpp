@@ -0,0 +1,192 @@
+#pragma once
+
+#include <median_filters.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+using namespace nrg_tools;
+
+BasicMedianMultiFilter::BasicMedianMultiFilter(int window_size, std::vector<double> init_values, double hampel_threshold)
+{
+	if(window_size < 1)
+	{
+		throw std::invalid_argument("Window size must be positive");
+	}
+	num_filters_ = init_values.size();
+	window_size_ = window_size;
+	lower_size_ = (window_size + 1) / 2;
+	upper_size_ = window_size / 2;
+	hampel_threshold_ = hampel_threshold;
+
+	window_.resize(num_filters_ * window_size_);
+	where_.resize(num_filters_ * window_size_);
+	lower_.resize(num_filters_ * lower_size_);
+	upper_.resize(num_filters_ * upper_size_);
+	scratch_.resize(window_size_);
+	reset(init_values);
+}
+
+std::vector<double> BasicMedianMultiFilter::filter(const std::vector<double>& new_measurements)
+{
+	if(new_measurements.size() != num_filters_)
+	{
+		throw std::out_of_range("New Measurement vector must be same size as the number of filters");
+	}
+
+	std::vector<double> output(num_filters_);
+	for(size_t i=0; i<num_filters_; ++i)
+	{
+		replace(i, oldest_, new_measurements[i]);
+		output[i] = median(i);
+
+		if(hampel_threshold_ > 0)
+		{
+			// Median absolute deviation, scaled to a standard deviation for normally distributed data
+			const double* window = &window_[i*window_size_];
+			for(int j=0; j<window_size_; ++j)
+			{
+				scratch_[j] = std::fabs(window[j] - output[i]);
+			}
+			std::nth_element(scratch_.begin(), scratch_.begin() + (window_size_ - 1) / 2, scratch_.end());
+			const double sigma = 1.4826 * scratch_[(window_size_ - 1) / 2];
+			if(std::fabs(new_measurements[i] - output[i]) <= hampel_threshold_ * sigma)
+			{
+				output[i] = new_measurements[i];
+			}
+		}
+	}
+	oldest_ = (oldest_ + 1) % window_size_;
+	return output;
+}
+
+void BasicMedianMultiFilter::reset(const std::vector<double>& reset_values)
+{
+	if(reset_values.size() != num_filters_)
+	{
+		throw std::out_of_range("Reset Values vector must be same size as the number of filters");
+	}
+	for(size_t i=0; i<num_filters_; ++i)
+	{
+		reset(i, reset_values[i]);
+	}
+}
+
+void BasicMedianMultiFilter::reset(const int index, const double reset_value)
+{
+	if(index < 0 || static_cast<size_t>(index) >= num_filters_)
+	{
+		throw std::out_of_range("Given index is higher than the number of filters");
+	}
+
+	// With every measurement equal, any split into the two heaps is valid
+	for(int j=0; j<window_size_; ++j)
+	{
+		window_[index*window_size_ + j] = reset_value;
+	}
+	for(int j=0; j<lower_size_; ++j)
+	{
+		lower_[index*lower_size_ + j] = j;
+		where_[index*window_size_ + j] = j;
+	}
+	for(int j=0; j<upper_size_; ++j)
+	{
+		upper_[index*upper_size_ + j] = lower_size_ + j;
+		where_[index*window_size_ + lower_size_ + j] = -(j + 1);
+	}
+}
+
+void BasicMedianMultiFilter::replace(const size_t filter, const int slot, const double value)
+{
+	window_[filter*window_size_ + slot] = value;
+	const int position = where_[filter*window_size_ + slot];
+	if(position >= 0)
+	{
+		siftLower(filter, position);
+	}
+	else
+	{
+		siftUpper(filter, -position - 1);
+	}
+
+	// If the new value crossed the median, the tops of the heaps swap sides
+	if(upper_size_ == 0) return;
+	const double* window = &window_[filter*window_size_];
+	int& lower_top = lower_[filter*lower_size_];
+	int& upper_top = upper_[filter*upper_size_];
+	if(window[lower_top] > window[upper_top])
+	{
+		std::swap(lower_top, upper_top);
+		where_[filter*window_size_ + lower_top] = 0;
+		where_[filter*window_size_ + upper_top] = -1;
+		siftLower(filter, 0);
+		siftUpper(filter, 0);
+	}
+}
+
+double BasicMedianMultiFilter::median(const size_t filter) const
+{
+	const double* window = &window_[filter*window_size_];
+	const double lower_top = window[lower_[filter*lower_size_]];
+	if(lower_size_ > upper_size_) return lower_top;
+	return 0.5 * (lower_top + window[upper_[filter*upper_size_]]);
+}
+
+void BasicMedianMultiFilter::swapLower(const size_t filter, const int i, const int j)
+{
+	int* heap = &lower_[filter*lower_size_];
+	std::swap(heap[i], heap[j]);
+	where_[filter*window_size_ + heap[i]] = i;
+	where_[filter*window_size_ + heap[j]] = j;
+}
+
+void BasicMedianMultiFilter::swapUpper(const size_t filter, const int i, const int j)
+{
+	int* heap = &upper_[filter*upper_size_];
+	std::swap(heap[i], heap[j]);
+	where_[filter*window_size_ + heap[i]] = -(i + 1);
+	where_[filter*window_size_ + heap[j]] = -(j + 1);
+}
+
+void BasicMedianMultiFilter::siftLower(const size_t filter, int i)
+{
+	// Max heap: move up while larger than the parent, then down while smaller than a child
+	const double* window = &window_[filter*window_size_];
+	const int* heap = &lower_[filter*lower_size_];
+	while(i > 0 && window[heap[i]] > window[heap[(i-1)/2]])
+	{
+		swapLower(filter, i, (i-1)/2);
+		i = (i-1)/2;
+	}
+	while(true)
+	{
+		int largest = i;
+		const int left = 2*i + 1, right = 2*i + 2;
+		if(left < lower_size_ && window[heap[left]] > window[heap[largest]]) largest = left;
+		if(right < lower_size_ && window[heap[right]] > window[heap[largest]]) largest = right;
+		if(largest == i) break;
+		swapLower(filter, i, largest);
+		i = largest;
+	}
+}
+
+void BasicMedianMultiFilter::siftUpper(const size_t filter, int i)
+{
+	// Min heap: move up while smaller than the parent, then down while larger than a child
+	const double* window = &window_[filter*window_size_];
+	const int* heap = &upper_[filter*upper_size_];
+	while(i > 0 && window[heap[i]] < window[heap[(i-1)/2]])
+	{
+		swapUpper(filter, i, (i-1)/2);
+		i = (i-1)/2;
+	}
+	while(true)
+	{
+		int smallest = i;
+		const int left = 2*i + 1, right = 2*i + 2;
+		if(left < upper_size_ && window[heap[left]] < window[heap[smallest]]) smallest = left;
+		if(right < upper_size_ && window[heap[right]] < window[heap[smallest]]) smallest = right;
+		if(smallest == i) break;
+		swapUpper(filter, i, smallest);
+		i = smallest;
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+namespace nrg_tools{
+	/**
+	 * \class BasicMedianMultiFilter
+	 * A sliding window median filter for a vector of values, with no ROS capabilities.
+	 * Good at removing single sample spikes, which a low pass filter would smear out.
+	 * Filters each value in the vector seperately.
+	 *
+	 * Each window is kept in two heaps around the median, indexed by the position of the samples in the window.
+	 * A new measurement replaces the oldest one in place, so each update is O(log(window_size)) with no allocations.
+	 *
+	 * With a Hampel threshold, only outliers are replaced by the median, and other measurements pass through unchanged
+	 */
+	class BasicMedianMultiFilter
+	{
+	public:
+		/**
+		 * Constructor
+		 * @param window_size			The number of measurements the median is taken over. Odd sizes are reccomended
+		 * @param init_values			The starting values of the filter. Make sure the length matches what you want to filter later
+		 * @param hampel_threshold		If greater than 0, the filter is a Hampel filter: measurements further than
+		 *								hampel_threshold standard deviations (estimated from the median absolute deviation)
+		 *								from the median are replaced by the median. Reccomended value = 3.
+		 *								The deviation estimate is O(window_size) per update
+		 */
+		BasicMedianMultiFilter(int window_size, std::vector<double> init_values, double hampel_threshold=0.0);
+
+		/**
+		 * Updates the filters with the new measurements and returns the filtered data as a vector
+		 * @param new_measurements	The new data to be filtered
+		 * @return 					The filtered measurement after accounting for the newest data
+		 */
+		std::vector<double> filter(const std::vector<double>& new_measurements);
+
+		/**
+		 * Sets all of the filters to the desired values
+		 * @param reset_values	The values to set the filters to
+		 */
+		void reset(const std::vector<double>& reset_values);
+
+		/**
+		 * Sets the filter at the desired index to a desired value
+		 * Throws an error if the index is out of range
+		 * @param index			The index of the filter to change
+		 * @param reset_value	The value to set the filter to
+		 */
+		void reset(const int index, const double reset_value);
+
+		/**
+		 * Gets the number of filters this multi filter is tracking
+		 * @return		The number of filters
+		 */
+		size_t getNumberFilters(){return num_filters_;};
+
+	private:
+		size_t num_filters_ = 0;
+		int window_size_ = 1;
+		int lower_size_ = 1;
+		int upper_size_ = 0;
+		int oldest_ = 0;
+		double hampel_threshold_ = 0.0;
+
+		// Per filter blocks, all stored back to back
+		std::vector<double> window_;		// Measurements, in ring buffer order
+		std::vector<int> where_;			// Heap position of each measurement. >= 0 in the lower heap, < 0 in the upper heap
+		std::vector<int> lower_;			// Max heap of window indices for the lower half (including the median)
+		std::vector<int> upper_;			// Min heap of window indices for the upper half
+		std::vector<double> scratch_;		// For the median absolute deviation
+
+		/**
+		 * Replaces the oldest measurement of a filter and restores the heap order
+		 */
+		void replace(const size_t filter, const int slot, const double value);
+
+		/**
+		 * Gets the current median of a filter
+		 */
+		double median(const size_t filter) const;
+
+		void swapLower(const size_t filter, const int i, const int j);
+		void swapUpper(const size_t filter, const int i, const int j);
+		void siftLower(const size_t filter, int i);
+		void siftUpper(const size_t filter, int i);
+	};
+
+} //end nrg_tools namespace
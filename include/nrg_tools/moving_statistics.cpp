@@ -0,0 +1,138 @@
+#pragma once
+
+#include <moving_statistics.h>
+#include <conversions.hpp>
+#include <algorithm>
+#include <stdexcept>
+using namespace nrg_tools;
+
+BasicMovingStatistics::BasicMovingStatistics(int window_size, size_t num_channels)
+{
+	if(window_size < 1)
+	{
+		throw std::invalid_argument("Window size must be positive");
+	}
+	window_size_ = window_size;
+	num_channels_ = num_channels;
+
+	window_.resize(window_size_ * num_channels_);
+	min_queue_.resize(window_size_ * num_channels_);
+	max_queue_.resize(window_size_ * num_channels_);
+	reset();
+}
+
+void BasicMovingStatistics::update(const std::vector<double>& new_measurements)
+{
+	if(new_measurements.size() != num_channels_)
+	{
+		throw std::out_of_range("New Measurement vector must be same size as the number of channels");
+	}
+
+	const size_t slot = time_ % window_size_;
+	double* window = &window_[slot * num_channels_];
+	if(count_ < window_size_)
+	{
+		// Still filling the window, so this is the standard Welford update
+		++count_;
+		for(size_t i=0; i<num_channels_; ++i)
+		{
+			const double delta = new_measurements[i] - mean_[i];
+			mean_[i] += delta / count_;
+			m2_[i] += delta * (new_measurements[i] - mean_[i]);
+			window[i] = new_measurements[i];
+		}
+	}
+	else
+	{
+		// Replace the oldest measurement, which is in the slot being overwritten
+		for(size_t i=0; i<num_channels_; ++i)
+		{
+			const double old_value = window[i];
+			const double old_mean = mean_[i];
+			mean_[i] += (new_measurements[i] - old_value) / count_;
+			m2_[i] += (new_measurements[i] - old_value) * (new_measurements[i] - mean_[i] + old_value - old_mean);
+			m2_[i] = std::max(m2_[i], 0.0);
+			window[i] = new_measurements[i];
+		}
+	}
+
+	for(size_t i=0; i<num_channels_; ++i)
+	{
+		pushQueue(&min_queue_[i*window_size_], min_head_[i], min_size_[i], i, true);
+		pushQueue(&max_queue_[i*window_size_], max_head_[i], max_size_[i], i, false);
+	}
+	++time_;
+}
+
+template <class T> void BasicMovingStatistics::update(const T& new_measurement)
+{
+	convert(new_measurement, scratch_);
+	update(scratch_);
+}
+
+void BasicMovingStatistics::reset()
+{
+	count_ = 0;
+	time_ = 0;
+	mean_.assign(num_channels_, 0.0);
+	m2_.assign(num_channels_, 0.0);
+	min_head_.assign(num_channels_, 0);
+	min_size_.assign(num_channels_, 0);
+	max_head_.assign(num_channels_, 0);
+	max_size_.assign(num_channels_, 0);
+}
+
+std::vector<double> BasicMovingStatistics::getVariance() const
+{
+	std::vector<double> output(num_channels_, 0.0);
+	if(count_ < 2) return output;
+	for(size_t i=0; i<num_channels_; ++i)
+	{
+		output[i] = m2_[i] / (count_ - 1);
+	}
+	return output;
+}
+
+std::vector<double> BasicMovingStatistics::getMin() const
+{
+	std::vector<double> output(num_channels_, 0.0);
+	for(size_t i=0; i<num_channels_ && count_ > 0; ++i)
+	{
+		const uint64_t time = min_queue_[i*window_size_ + min_head_[i]];
+		output[i] = window_[(time % window_size_) * num_channels_ + i];
+	}
+	return output;
+}
+
+std::vector<double> BasicMovingStatistics::getMax() const
+{
+	std::vector<double> output(num_channels_, 0.0);
+	for(size_t i=0; i<num_channels_ && count_ > 0; ++i)
+	{
+		const uint64_t time = max_queue_[i*window_size_ + max_head_[i]];
+		output[i] = window_[(time % window_size_) * num_channels_ + i];
+	}
+	return output;
+}
+
+void BasicMovingStatistics::pushQueue(uint64_t* queue, size_t& head, size_t& size, const size_t channel, const bool is_min)
+{
+	// Drop the front if it has left the window
+	if(size > 0 && queue[head] + window_size_ <= time_)
+	{
+		head = (head + 1) % window_size_;
+		--size;
+	}
+
+	// Drop entries from the back that can no longer be the min (max), since the new value is smaller (larger) and newer
+	const double value = window_[(time_ % window_size_) * num_channels_ + channel];
+	while(size > 0)
+	{
+		const uint64_t back_time = queue[(head + size - 1) % window_size_];
+		const double back_value = window_[(back_time % window_size_) * num_channels_ + channel];
+		if(is_min ? (back_value < value) : (back_value > value)) break;
+		--size;
+	}
+	queue[(head + size) % window_size_] = time_;
+	++size;
+}
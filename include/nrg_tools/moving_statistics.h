@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace nrg_tools{
+	/**
+	 * \class BasicMovingStatistics
+	 * Mean, variance, min and max over a sliding window, for a vector of values (channels) with no ROS capabilities.
+	 * Useful for sensor health monitoring. Each update is O(1) amortized per channel, regardless of the window size:
+	 * the mean and variance are updated incrementally (Welford's method, extended to remove the oldest sample),
+	 * and the min and max are tracked with monotonic queues.
+	 * The state of every channel is stored in separate arrays, so updates loop over contiguous memory
+	 */
+	class BasicMovingStatistics
+	{
+	public:
+		/**
+		 * Constructor
+		 * @param window_size		The number of measurements the statistics are taken over
+		 * @param num_channels		The number of values in each measurement
+		 */
+		BasicMovingStatistics(int window_size, size_t num_channels);
+
+		/**
+		 * Adds new measurements, dropping the oldest ones once the window is full
+		 * @param new_measurements	The new data, one value per channel
+		 */
+		void update(const std::vector<double>& new_measurements);
+
+		/**
+		 * Adds a new measurement of any type with valid conversion functions (e.g. a ROS message)
+		 * @param new_measurement	The new data. Must convert to one value per channel
+		 */
+		template <class T> void update(const T& new_measurement);
+
+		/**
+		 * Clears all measurements
+		 */
+		void reset();
+
+		/**
+		 * Gets the mean of each channel over the window
+		 * @return		The means, or zeros if there are no measurements
+		 */
+		const std::vector<double>& getMean() const {return mean_;};
+
+		/**
+		 * Gets the sample variance of each channel over the window
+		 * @return		The variances, or zeros if there are fewer than 2 measurements
+		 */
+		std::vector<double> getVariance() const;
+
+		/**
+		 * Gets the minimum of each channel over the window
+		 * @return		The minimums, or zeros if there are no measurements
+		 */
+		std::vector<double> getMin() const;
+
+		/**
+		 * Gets the maximum of each channel over the window
+		 * @return		The maximums, or zeros if there are no measurements
+		 */
+		std::vector<double> getMax() const;
+
+		/**
+		 * Gets the number of measurements currently in the window
+		 * @return		The number of measurements, at most the window size
+		 */
+		size_t getCount() const {return count_;};
+
+		/**
+		 * Gets the number of channels
+		 * @return		The number of values in each measurement
+		 */
+		size_t getNumberChannels() const {return num_channels_;};
+
+	private:
+		size_t num_channels_ = 0;
+		size_t window_size_ = 1;
+		size_t count_ = 0;
+		uint64_t time_ = 0;
+
+		std::vector<double> window_;		// Measurements in ring buffer order, window_[slot*num_channels_ + channel]
+		std::vector<double> mean_;
+		std::vector<double> m2_;			// Sum of squared differences from the mean
+
+		// Monotonic queues of measurement times per channel, increasing values for the min and decreasing for the max.
+		// Each is a ring of window_size_ entries at [channel*window_size_]
+		std::vector<uint64_t> min_queue_, max_queue_;
+		std::vector<size_t> min_head_, min_size_, max_head_, max_size_;
+		std::vector<double> scratch_;
+
+		/**
+		 * Pushes a measurement into a monotonic queue, removing entries it makes irrelevant and entries that left the window
+		 */
+		void pushQueue(uint64_t* queue, size_t& head, size_t& size, const size_t channel, const bool is_min);
+	};
+
+} //end nrg_tools namespace
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <multirate_filters.h>
+#include <cmath>
+#include <stdexcept>
+using namespace nrg_tools;
+
+std::vector<double> nrg_tools::designLowPassFir(const size_t num_taps, const double cutoff)
+{
+	std::vector<double> coefficients(num_taps);
+	const double center = 0.5 * (num_taps - 1.);
+	double sum = 0.0;
+	for(size_t i=0; i<num_taps; ++i)
+	{
+		const double t = i - center;
+		const double sinc = (t == 0) ? 2. * cutoff : std::sin(2. * M_PI * cutoff * t) / (M_PI * t);
+		const double window = (num_taps > 1) ? 0.54 - 0.46 * std::cos(2. * M_PI * i / (num_taps - 1.)) : 1.0;
+		coefficients[i] = sinc * window;
+		sum += coefficients[i];
+	}
+	for(size_t i=0; i<num_taps; ++i)
+	{
+		coefficients[i] /= sum;
+	}
+	return coefficients;
+}
+
+// ~~~~~~~~~~~~~ Decimating Filter ~~~~~~~~~~~~~~~~~~~~~~~~
+BasicDecimatingMultiFilter::BasicDecimatingMultiFilter(int factor, std::vector<double> init_values, int taps_per_output, double cutoff_ratio)
+{
+	if(factor < 1 || taps_per_output < 1)
+	{
+		throw std::invalid_argument("Decimation factor and number of taps must be positive");
+	}
+	factor_ = factor;
+	num_filters_ = init_values.size();
+	num_taps_ = factor * taps_per_output;
+
+	// The history is stored oldest to newest, so the coefficients are reversed to match
+	coefficients_ = designLowPassFir(num_taps_, 0.5 * cutoff_ratio / factor);
+	coefficients_.assign(coefficients_.rbegin(), coefficients_.rend());
+
+	history_.resize(2 * num_taps_ * num_filters_);
+	reset(init_values);
+}
+
+bool BasicDecimatingMultiFilter::filter(const std::vector<double>& new_measurements, std::vector<double>& output)
+{
+	if(new_measurements.size() != num_filters_)
+	{
+		throw std::out_of_range("New Measurement vector must be same size as the number of filters");
+	}
+
+	// Store the measurement in both halves of the ring buffer
+	for(size_t i=0; i<num_filters_; ++i)
+	{
+		history_[position_*num_filters_ + i] = new_measurements[i];
+		history_[(position_ + num_taps_)*num_filters_ + i] = new_measurements[i];
+	}
+	position_ = (position_ + 1) % num_taps_;
+
+	if(++phase_ < factor_) return false;
+	phase_ = 0;
+
+	// The last num_taps_ measurements now start at position_, oldest first
+	output.assign(num_filters_, 0.0);
+	const double* window = &history_[position_*num_filters_];
+	for(size_t j=0; j<num_taps_; ++j)
+	{
+		const double coefficient = coefficients_[j];
+		const double* sample = window + j*num_filters_;
+		for(size_t i=0; i<num_filters_; ++i)
+		{
+			output[i] += coefficient * sample[i];
+		}
+	}
+	return true;
+}
+
+void BasicDecimatingMultiFilter::reset(const std::vector<double>& reset_values)
+{
+	if(reset_values.size() != num_filters_)
+	{
+		throw std::out_of_range("Reset Values vector must be same size as the number of filters");
+	}
+	for(size_t j=0; j<2*num_taps_; ++j)
+	{
+		for(size_t i=0; i<num_filters_; ++i)
+		{
+			history_[j*num_filters_ + i] = reset_values[i];
+		}
+	}
+	phase_ = 0;
+}
+
+// ~~~~~~~~~~~~~ Interpolating Filter ~~~~~~~~~~~~~~~~~~~~~
+BasicInterpolatingMultiFilter::BasicInterpolatingMultiFilter(int factor, std::vector<double> init_values, int taps_per_input, double cutoff_ratio)
+{
+	if(factor < 1 || taps_per_input < 1)
+	{
+		throw std::invalid_argument("Interpolation factor and number of taps must be positive");
+	}
+	factor_ = factor;
+	num_filters_ = init_values.size();
+	taps_per_input_ = taps_per_input;
+
+	// Split the prototype into one branch per output phase. Branch p applies h[p + j*factor]
+	// to the input j samples ago, and is stored oldest first to match the history
+	const std::vector<double> prototype = designLowPassFir(factor * taps_per_input, 0.5 * cutoff_ratio / factor);
+	branches_.resize(factor * taps_per_input);
+	for(int p=0; p<factor_; ++p)
+	{
+		double sum = 0.0;
+		for(size_t j=0; j<taps_per_input_; ++j)
+		{
+			sum += prototype[p + j*factor_];
+		}
+		for(size_t j=0; j<taps_per_input_; ++j)
+		{
+			branches_[p*taps_per_input_ + (taps_per_input_ - 1 - j)] = prototype[p + j*factor_] / sum;
+		}
+	}
+
+	history_.resize(2 * taps_per_input_ * num_filters_);
+	reset(init_values);
+}
+
+void BasicInterpolatingMultiFilter::push(const std::vector<double>& new_measurements)
+{
+	if(new_measurements.size() != num_filters_)
+	{
+		throw std::out_of_range("New Measurement vector must be same size as the number of filters");
+	}
+	for(size_t i=0; i<num_filters_; ++i)
+	{
+		history_[position_*num_filters_ + i] = new_measurements[i];
+		history_[(position_ + taps_per_input_)*num_filters_ + i] = new_measurements[i];
+	}
+	position_ = (position_ + 1) % taps_per_input_;
+	phase_ = 0;
+}
+
+bool BasicInterpolatingMultiFilter::next(std::vector<double>& output)
+{
+	if(phase_ >= factor_)
+	{
+		output = last_output_;
+		return false;
+	}
+
+	last_output_.assign(num_filters_, 0.0);
+	const double* window = &history_[position_*num_filters_];
+	const double* branch = &branches_[phase_*taps_per_input_];
+	for(size_t j=0; j<taps_per_input_; ++j)
+	{
+		const double* sample = window + j*num_filters_;
+		for(size_t i=0; i<num_filters_; ++i)
+		{
+			last_output_[i] += branch[j] * sample[i];
+		}
+	}
+	++phase_;
+	output = last_output_;
+	return true;
+}
+
+void BasicInterpolatingMultiFilter::reset(const std::vector<double>& reset_values)
+{
+	if(reset_values.size() != num_filters_)
+	{
+		throw std::out_of_range("Reset Values vector must be same size as the number of filters");
+	}
+	for(size_t j=0; j<2*taps_per_input_; ++j)
+	{
+		for(size_t i=0; i<num_filters_; ++i)
+		{
+			history_[j*num_filters_ + i] = reset_values[i];
+		}
+	}
+	last_output_ = reset_values;
+	phase_ = factor_;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+namespace nrg_tools{
+	/**
+	 * Designs a linear phase low pass FIR filter (Hamming windowed sinc), normalized to unity DC gain
+	 * @param num_taps		The number of coefficients
+	 * @param cutoff		The cutoff frequency as a fraction of the sample rate (0 to 0.5)
+	 * @return 				The filter coefficients
+	 */
+	std::vector<double> designLowPassFir(const size_t num_taps, const double cutoff);
+
+	/**
+	 * \class BasicDecimatingMultiFilter
+	 * An anti-aliasing decimator for a vector of values, with no ROS capabilities.
+	 * Takes measurements at a high rate and outputs every factor-th sample of the low pass filtered signal.
+	 * Measurements are only stored as they come in; the FIR filter is evaluated for the outputs only,
+	 * so the cost is paid at the output rate
+	 */
+	class BasicDecimatingMultiFilter
+	{
+	public:
+		/**
+		 * Constructor
+		 * @param factor				The ratio of input rate to output rate (e.g. 14 for 7 kHz to 500 Hz)
+		 * @param init_values			The starting values of the filter. Make sure the length matches what you want to filter later
+		 * @param taps_per_output		Length of the FIR filter in output samples. Higher = sharper cutoff, but more lag. Reccomended default = 8
+		 * @param cutoff_ratio			The cutoff frequency as a fraction of the output Nyquist frequency. Reccomended default = 0.8
+		 */
+		BasicDecimatingMultiFilter(int factor, std::vector<double> init_values, int taps_per_output=8, double cutoff_ratio=0.8);
+
+		/**
+		 * Adds a new measurement, and computes an output if one is due
+		 * @param new_measurements	The new data to be filtered
+		 * @param output			The filtered, decimated data. Only written when the function returns 'true'
+		 * @return 					'true' on every factor-th call, when a new output was computed
+		 */
+		bool filter(const std::vector<double>& new_measurements, std::vector<double>& output);
+
+		/**
+		 * Sets all of the filters to the desired values
+		 * @param reset_values	The values to set the filters to
+		 */
+		void reset(const std::vector<double>& reset_values);
+
+		/**
+		 * Gets the number of filters this multi filter is tracking
+		 * @return		The number of filters
+		 */
+		size_t getNumberFilters(){return num_filters_;};
+
+		/**
+		 * Gets the decimation factor
+		 * @return		The ratio of input rate to output rate
+		 */
+		int getFactor(){return factor_;};
+
+	private:
+		size_t num_filters_ = 0;
+		int factor_ = 1;
+		int phase_ = 0;
+		size_t num_taps_ = 0;
+		size_t position_ = 0;
+		std::vector<double> coefficients_;
+		// Ring buffer of the last num_taps_ measurements, stored twice so the window is always contiguous
+		std::vector<double> history_;
+	};
+
+	/**
+	 * \class BasicInterpolatingMultiFilter
+	 * A polyphase interpolator for a vector of values, with no ROS capabilities.
+	 * Takes measurements (e.g. commands) at a low rate and produces a smooth signal at factor times that rate.
+	 * Constant inputs are reproduced exactly
+	 */
+	class BasicInterpolatingMultiFilter
+	{
+	public:
+		/**
+		 * Constructor
+		 * @param factor				The ratio of output rate to input rate
+		 * @param init_values			The starting values of the filter. Make sure the length matches what you want to filter later
+		 * @param taps_per_input		Length of each polyphase branch in input samples. Higher = smoother, but more lag. Reccomended default = 4
+		 * @param cutoff_ratio			The cutoff frequency as a fraction of the input Nyquist frequency. Reccomended default = 0.8
+		 */
+		BasicInterpolatingMultiFilter(int factor, std::vector<double> init_values, int taps_per_input=4, double cutoff_ratio=0.8);
+
+		/**
+		 * Adds a new low rate measurement. The next factor calls to next() interpolate up to it
+		 * @param new_measurements	The new data to be interpolated
+		 */
+		void push(const std::vector<double>& new_measurements);
+
+		/**
+		 * Gets the next high rate output. If it is called more than factor times without a new measurement,
+		 * the last output is repeated
+		 * @param output	The interpolated data
+		 * @return 			'false' if the last output was repeated, 'true' otherwise
+		 */
+		bool next(std::vector<double>& output);
+
+		/**
+		 * Sets all of the filters to the desired values
+		 * @param reset_values	The values to set the filters to
+		 */
+		void reset(const std::vector<double>& reset_values);
+
+		/**
+		 * Gets the number of filters this multi filter is tracking
+		 * @return		The number of filters
+		 */
+		size_t getNumberFilters(){return num_filters_;};
+
+		/**
+		 * Gets the interpolation factor
+		 * @return		The ratio of output rate to input rate
+		 */
+		int getFactor(){return factor_;};
+
+	private:
+		size_t num_filters_ = 0;
+		int factor_ = 1;
+		int phase_ = 0;
+		size_t taps_per_input_ = 0;
+		size_t position_ = 0;
+		// One branch of taps_per_input_ coefficients per output phase, each normalized to unity DC gain
+		std::vector<double> branches_;
+		// Ring buffer of the last taps_per_input_ measurements, stored twice so the window is always contiguous
+		std::vector<double> history_;
+		std::vector<double> last_output_;
+	};
+
+} //end nrg_tools namespace
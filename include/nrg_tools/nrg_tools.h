@@ -1,7 +1,24 @@
 #pragma once
 
+#include <allocation_audit.hpp>
+#include <arena_allocator.hpp>
 #include <controller_tools.hpp>
 #include <conversions.hpp>
+#include <filter_snapshot.hpp>
+#include <fused_pipeline.hpp>
+#include <joint_order_plan.hpp>
+#include <point_cloud_tools.hpp>
 #include <printing.hpp>
+#include <profiling.hpp>
+#include <spsc_ring.hpp>
+#include <stamped_cache.hpp>
+#include <trajectory_tools.hpp>
+#include <transform_tools.hpp>
 #include <basic_lowpass_filters.cpp>
-#include <ros_lowpass_filter.cpp>
\ No newline at end of file
+#include <differentiators.cpp>
+#include <moving_statistics.cpp>
+#include <ros_kalman_filter.cpp>
+#include <ros_lowpass_filter.cpp>
+#include <ros_median_filter.cpp>
+#include <ros_multirate_filters.cpp>
+#include <ros_pose_filter.cpp>
\ No newline at end of file
@@ -0,0 +1,205 @@
+#pragma once
+
+/**
+ * Nodelets wrapping the filters and bounds of nrg_tools, so that processing chains
+ * (e.g. sensor -> filter -> limit -> controller) can run in a single process.
+ * Messages are passed as boost::shared_ptr's, which nodelets in the same manager
+ * receive without serialization or copies.
+ *
+ * Every stage subscribes to "input" and publishes on "output"
+ */
+
+#include <nodelet/nodelet.h>
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <memory>
+#include <controller_tools.hpp>
+#include <ros_lowpass_filter.cpp>
+
+namespace nrg_tools{
+
+	/**
+	 * \class FilterNodelet
+	 * Low pass filters messages of type T with a RosLowPassFilter<T>.
+	 * The filter starts at the value of the first message received. If the coefficients do not
+	 * match that message, the error is logged once and the nodelet stops listening.
+	 *
+	 * Parameters:
+	 *   ~filter_coefficients	List with one coefficient per element of the message, or
+	 *   ~filter_coefficient	A single coefficient used for every element (default 2.0)
+	 */
+	template <class T> class FilterNodelet : public nodelet::Nodelet
+	{
+	private:
+		std::unique_ptr<RosLowPassFilter<T> > filter_;
+		bool filter_failed_ = false;
+		ros::Publisher publisher_;
+		ros::Subscriber subscriber_;
+
+		void onInit()
+		{
+			ros::NodeHandle& nh = getNodeHandle();
+			publisher_ = nh.advertise<T>("output", 10);
+			subscriber_ = nh.subscribe("input", 10, &FilterNodelet<T>::callback, this, ros::TransportHints().tcpNoDelay());
+		}
+
+		/**
+		 * Makes the filter from the parameters, sized to match the first message.
+		 * On failure the subscriber is shut down and the failure is latched, so it is not retried on every message
+		 */
+		bool makeFilter(const T& first_message)
+		{
+			std::vector<double> coeff_vector;
+			convert(first_message, coeff_vector);
+			if(!getPrivateNodeHandle().getParam("filter_coefficients", coeff_vector))
+			{
+				coeff_vector.assign(coeff_vector.size(), getPrivateNodeHandle().param<double>("filter_coefficient", 2.0));
+			}
+
+			T coeffs = first_message;
+			if(!convert(coeff_vector, coeffs))
+			{
+				NODELET_ERROR("Filter coefficients do not match the size of the message, no longer filtering");
+				filter_failed_ = true;
+				subscriber_.shutdown();
+				return false;
+			}
+			filter_.reset(new RosLowPassFilter<T>(coeffs));
+			filter_->reset(first_message);
+			return true;
+		}
+
+		void callback(const boost::shared_ptr<const T>& message)
+		{
+			if(filter_failed_ || (!filter_ && !makeFilter(*message))) return;
+			try
+			{
+				publisher_.publish(boost::make_shared<T>(filter_->filter(*message)));
+			}
+			catch(const std::exception& e)
+			{
+				NODELET_ERROR("Filtering failed: %s", e.what());
+			}
+		}
+	};
+
+	/**
+	 * \class BoundNodelet
+	 * Bounds messages of type T with boundUniform() if ~limit is given, or boundAll() otherwise.
+	 *
+	 * Parameters:
+	 *   ~limit		List with the (plus and minus) limit of each element of the message, or
+	 *   ~lower		List with the lower limit of each element of the message, and
+	 *   ~upper		List with the upper limit of each element of the message
+	 */
+	template <class T> class BoundNodelet : public nodelet::Nodelet
+	{
+	private:
+		std::vector<double> lower_, upper_, limit_;
+		ros::Publisher publisher_;
+		ros::Subscriber subscriber_;
+
+		void onInit()
+		{
+			ros::NodeHandle& pnh = getPrivateNodeHandle();
+			if(!pnh.getParam("limit", limit_) && !(pnh.getParam("lower", lower_) && pnh.getParam("upper", upper_)))
+			{
+				NODELET_ERROR("Either ~limit or both ~lower and ~upper must be set");
+				return;
+			}
+
+			ros::NodeHandle& nh = getNodeHandle();
+			publisher_ = nh.advertise<T>("output", 10);
+			subscriber_ = nh.subscribe("input", 10, &BoundNodelet<T>::callback, this, ros::TransportHints().tcpNoDelay());
+		}
+
+		void callback(const boost::shared_ptr<const T>& message)
+		{
+			try
+			{
+				if(!limit_.empty())
+				{
+					publisher_.publish(boost::make_shared<T>(boundUniform(*message, limit_)));
+				}
+				else
+				{
+					publisher_.publish(boost::make_shared<T>(boundAll(*message, lower_, upper_)));
+				}
+			}
+			catch(const std::exception& e)
+			{
+				NODELET_ERROR("Bounding failed: %s", e.what());
+			}
+		}
+	};
+
+	/**
+	 * \class LatencyProbeNodelet
+	 * Measures the end-to-end latency of a chain. Publishes stamped messages of type T on "probe_output"
+	 * at a fixed rate, and reports the age of the messages that come back on "probe_input".
+	 * Used to compare a chain loaded in one nodelet manager against the same stages in separate processes.
+	 *
+	 * Parameters:
+	 *   ~rate				Publishing rate in Hz (default 1000)
+	 *   ~num_messages		Number of messages to measure before reporting (default 10000)
+	 *   ~num_warmup		Number of messages to ignore at the start (default 100)
+	 */
+	template <class T> class LatencyProbeNodelet : public nodelet::Nodelet
+	{
+	private:
+		int num_messages_ = 10000;
+		int num_warmup_ = 100;
+		int num_received_ = 0;
+		uint32_t seq_ = 0;
+		std::vector<double> latencies_;
+		ros::Publisher publisher_;
+		ros::Subscriber subscriber_;
+		ros::WallTimer timer_;
+
+		void onInit()
+		{
+			ros::NodeHandle& pnh = getPrivateNodeHandle();
+			const double rate = pnh.param<double>("rate", 1000.0);
+			num_messages_ = std::max(1, pnh.param<int>("num_messages", 10000));
+			num_warmup_ = pnh.param<int>("num_warmup", 100);
+			latencies_.reserve(num_messages_);
+
+			ros::NodeHandle& nh = getNodeHandle();
+			publisher_ = nh.advertise<T>("probe_output", 10);
+			subscriber_ = nh.subscribe("probe_input", 10, &LatencyProbeNodelet<T>::callback, this, ros::TransportHints().tcpNoDelay());
+			timer_ = nh.createWallTimer(ros::WallDuration(1.0 / rate), &LatencyProbeNodelet<T>::timerCallback, this);
+		}
+
+		void timerCallback(const ros::WallTimerEvent& event)
+		{
+			boost::shared_ptr<T> message = boost::make_shared<T>();
+			message->header.seq = seq_++;
+			message->header.stamp = ros::Time::now();
+			publisher_.publish(message);
+		}
+
+		void callback(const boost::shared_ptr<const T>& message)
+		{
+			const double latency = (ros::Time::now() - message->header.stamp).toSec();
+			if(num_received_++ < num_warmup_ || (int)latencies_.size() >= num_messages_) return;
+
+			latencies_.push_back(latency);
+			if((int)latencies_.size() == num_messages_)
+			{
+				timer_.stop();
+				report();
+			}
+		}
+
+		void report()
+		{
+			std::sort(latencies_.begin(), latencies_.end());
+			double sum = 0;
+			for(size_t i=0; i<latencies_.size(); ++i) sum += latencies_[i];
+			const size_t n = latencies_.size();
+			NODELET_INFO("Latency over %zu messages [us]: mean %.1f, p50 %.1f, p90 %.1f, p99 %.1f, max %.1f",
+				n, 1e6 * sum / n, 1e6 * latencies_[n/2], 1e6 * latencies_[(n*9)/10], 1e6 * latencies_[(n*99)/100], 1e6 * latencies_[n-1]);
+		}
+	};
+
+} // end nrg_tools namespace
@@ -0,0 +1,236 @@
+#pragma once
+
+/**
+ * Access to the xyz data of sensor_msgs::PointCloud2 messages as Eigen types.
+ * When the cloud layout allows, the points are mapped directly onto the message
+ * buffer with no copy. Otherwise they are gathered into an Eigen::Matrix3Xd, with one strided loop per field
+ */
+
+#include "ros_msgs_includes.h"
+#include <Eigen/Eigen>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace nrg_tools{
+
+	/**
+	 * A read-only 3xN view of the xyz data in a point cloud buffer. Each column is
+	 * one point, and the outer stride is the point step of the cloud
+	 */
+	template <class Scalar> using CloudXYZMap = Eigen::Map<const Eigen::Matrix<Scalar, 3, Eigen::Dynamic>,
+	                                                       Eigen::Unaligned, Eigen::OuterStride<> >;
+
+	/**
+	 * The sensor_msgs::PointField datatype stored as Scalar. Only defined for the types
+	 * a view can read, so other types do not compile
+	 */
+	template <class Scalar> struct PointFieldDatatype;
+	template <> struct PointFieldDatatype<float> {static const uint8_t value = sensor_msgs::PointField::FLOAT32;};
+	template <> struct PointFieldDatatype<double> {static const uint8_t value = sensor_msgs::PointField::FLOAT64;};
+
+	/**
+	 * \class PointCloudXYZView
+	 * Inspects the layout of a sensor_msgs::PointCloud2 once, and then gives access to
+	 * its x, y and z fields either as a zero-copy Eigen::Map or as a gathered Eigen::Matrix3Xd.
+	 * Organized clouds are read row by row, so point (u, v) is column v*width + u.
+	 * The view only holds a reference, so the cloud must outlive it
+	 */
+	class PointCloudXYZView
+	{
+	public:
+		/**
+		 * Constructor
+		 * @param cloud		The cloud to read from. Must have FLOAT32 or FLOAT64 "x", "y" and "z" fields
+		 */
+		PointCloudXYZView(const sensor_msgs::PointCloud2& cloud);
+
+		/**
+		 * Checks that the cloud has usable x, y and z fields and a consistent buffer size
+		 * @return 		'true' if the points can be read, 'false' otherwise
+		 */
+		bool isValid() const {return valid_;};
+
+		/**
+		 * Checks if the points can be mapped directly without copying. This requires
+		 * x, y and z to be packed next to each other with the same type, host byte order,
+		 * and no padding at the end of the rows of an organized cloud
+		 * @return 		'true' if map() can be used, 'false' otherwise
+		 */
+		bool isMappable() const {return mappable_;};
+
+		/**
+		 * Gets the sensor_msgs::PointField datatype of the x, y and z fields.
+		 * Only meaningful when they share a type, which is always the case if isMappable()
+		 * @return 		The datatype of the x field
+		 */
+		uint8_t getDatatype() const {return datatype_[0];};
+
+		/**
+		 * Gets the number of points in the cloud, including invalid (NaN) ones
+		 * @return 		width * height of the cloud
+		 */
+		size_t getNumberPoints() const {return num_points_;};
+
+		/**
+		 * Maps the xyz data of the cloud without copying it.
+		 * Throws an error if the cloud is not mappable, or if Scalar does not match the datatype
+		 * @return 		A 3xN map of the points, only valid while the cloud is alive and unchanged
+		 */
+		template <class Scalar> CloudXYZMap<Scalar> map() const;
+
+		/**
+		 * Copies the points into an Eigen::Matrix3Xd. Uses the mapped data when possible and
+		 * otherwise reads each field with a strided loop for its type. The output is only allocated once
+		 * @param output		The gathered points, one per column
+		 * @param remove_nans	If 'true', points with a NaN or infinite coordinate are dropped
+		 * @param indices		Optional. Filled with the index in the cloud of each output column
+		 * @return 				Returns 'true' if the cloud is valid, 'false' otherwise
+		 */
+		bool gather(Eigen::Matrix3Xd& output, bool remove_nans=false, std::vector<int>* indices=NULL) const;
+
+	private:
+		const sensor_msgs::PointCloud2& cloud_;
+		bool valid_ = false;
+		bool mappable_ = false;
+		size_t num_points_ = 0;
+		uint32_t offset_[3] = {0, 0, 0};
+		uint8_t datatype_[3] = {0, 0, 0};
+		bool swap_bytes_ = false;
+
+		/**
+		 * Copies one field of every point into a row of the output, fixing the byte order if Swap is 'true'
+		 * @param field		The index of the field (0 = x, 1 = y, 2 = z)
+		 * @param output	The gathered points, already sized to the cloud
+		 */
+		template <class Scalar, bool Swap> void gatherField(size_t field, Eigen::Matrix3Xd& output) const;
+	};
+
+	inline PointCloudXYZView::PointCloudXYZView(const sensor_msgs::PointCloud2& cloud) : cloud_(cloud)
+	{
+		const char* names[3] = {"x", "y", "z"};
+		bool found[3] = {false, false, false};
+		for(size_t i=0; i<cloud_.fields.size(); ++i)
+		{
+			for(size_t j=0; j<3; ++j)
+			{
+				if(cloud_.fields[i].name == names[j] && cloud_.fields[i].count <= 1)
+				{
+					offset_[j] = cloud_.fields[i].offset;
+					datatype_[j] = cloud_.fields[i].datatype;
+					found[j] = true;
+				}
+			}
+		}
+
+		// Check that every field exists, fits in a point, and is a type we can read
+		valid_ = cloud_.point_step > 0 && cloud_.row_step >= size_t(cloud_.width) * cloud_.point_step;
+		for(size_t j=0; j<3; ++j)
+		{
+			size_t size = 0;
+			if(datatype_[j] == sensor_msgs::PointField::FLOAT32) size = sizeof(float);
+			else if(datatype_[j] == sensor_msgs::PointField::FLOAT64) size = sizeof(double);
+			valid_ = valid_ && found[j] && size > 0 && offset_[j] + size <= cloud_.point_step;
+		}
+		valid_ = valid_ && cloud_.data.size() >= size_t(cloud_.row_step) * cloud_.height;
+
+		const uint16_t endian_test = 1;
+		const bool host_bigendian = *reinterpret_cast<const uint8_t*>(&endian_test) == 0;
+		swap_bytes_ = cloud_.is_bigendian != host_bigendian;
+		num_points_ = valid_ ? size_t(cloud_.width) * cloud_.height : 0;
+		if(!valid_ || swap_bytes_) return;
+
+		// ROS buffers have no alignment guarantees, but a Map still needs aligned scalars
+		const size_t size = (datatype_[0] == sensor_msgs::PointField::FLOAT32) ? sizeof(float) : sizeof(double);
+		mappable_ = datatype_[1] == datatype_[0] && datatype_[2] == datatype_[0]
+			&& offset_[1] == offset_[0] + size && offset_[2] == offset_[0] + 2*size
+			&& cloud_.point_step % size == 0
+			&& (cloud_.height <= 1 || cloud_.row_step == size_t(cloud_.width) * cloud_.point_step)
+			&& reinterpret_cast<uintptr_t>(cloud_.data.data() + offset_[0]) % size == 0;
+	}
+
+	template <class Scalar> CloudXYZMap<Scalar> PointCloudXYZView::map() const
+	{
+		if(!mappable_ || PointFieldDatatype<Scalar>::value != datatype_[0])
+		{
+			throw std::invalid_argument("Point cloud layout cannot be mapped as the requested type");
+		}
+		const Scalar* data = reinterpret_cast<const Scalar*>(cloud_.data.data() + offset_[0]);
+		return CloudXYZMap<Scalar>(data, 3, num_points_, Eigen::OuterStride<>(cloud_.point_step / sizeof(Scalar)));
+	}
+
+	inline bool PointCloudXYZView::gather(Eigen::Matrix3Xd& output, bool remove_nans, std::vector<int>* indices) const
+	{
+		if(!valid_) return false;
+		output.resize(3, num_points_);
+
+		if(mappable_ && datatype_[0] == sensor_msgs::PointField::FLOAT32)
+		{
+			output = map<float>().cast<double>();
+		}
+		else if(mappable_)
+		{
+			output = map<double>();
+		}
+		else
+		{
+			// Generic path, handles row padding, mixed types, unpacked fields and byte order.
+			// The type is looked up once per field, so the per point loops have no branches
+			for(size_t j=0; j<3; ++j)
+			{
+				const bool is_float = datatype_[j] == sensor_msgs::PointField::FLOAT32;
+				if(is_float && swap_bytes_) gatherField<float, true>(j, output);
+				else if(is_float) gatherField<float, false>(j, output);
+				else if(swap_bytes_) gatherField<double, true>(j, output);
+				else gatherField<double, false>(j, output);
+			}
+		}
+
+		if(indices != NULL)
+		{
+			indices->clear();
+			indices->reserve(num_points_);
+		}
+		if(!remove_nans)
+		{
+			for(size_t i=0; indices != NULL && i<num_points_; ++i) indices->push_back(i);
+			return true;
+		}
+
+		// Compact the valid points to the front in place
+		size_t num_kept = 0;
+		for(size_t i=0; i<num_points_; ++i)
+		{
+			if(std::isfinite(output(0, i)) && std::isfinite(output(1, i)) && std::isfinite(output(2, i)))
+			{
+				if(num_kept != i) output.col(num_kept) = output.col(i);
+				if(indices != NULL) indices->push_back(i);
+				++num_kept;
+			}
+		}
+		output.conservativeResize(3, num_kept);
+		return true;
+	}
+
+	template <class Scalar, bool Swap> void PointCloudXYZView::gatherField(size_t field, Eigen::Matrix3Xd& output) const
+	{
+		size_t col = 0;
+		for(size_t v=0; v<cloud_.height; ++v)
+		{
+			const uint8_t* ptr = cloud_.data.data() + v*cloud_.row_step + offset_[field];
+			for(size_t u=0; u<cloud_.width; ++u, ++col, ptr += cloud_.point_step)
+			{
+				// The buffer has no alignment guarantees, so copy the bytes out instead of casting
+				uint8_t bytes[sizeof(Scalar)];
+				for(size_t i=0; i<sizeof(Scalar); ++i)
+				{
+					bytes[i] = Swap ? ptr[sizeof(Scalar)-1-i] : ptr[i];
+				}
+				Scalar value;
+				std::memcpy(&value, bytes, sizeof(Scalar));
+				output(field, col) = value;
+			}
+		}
+	}
+
+} // end nrg_tools namespace
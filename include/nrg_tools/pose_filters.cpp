@@ -0,0 +1,115 @@
+#pragma once
+
+#include <pose_filters.h>
+#include <profiling.hpp>
+#include <stdexcept>
+using namespace nrg_tools;
+
+BasicPoseMultiFilter::BasicPoseMultiFilter(double position_coefficient, double orientation_coefficient, const std::vector<double>& init_values,
+										   Interpolation interpolation)
+{
+	if(init_values.size() % 7 != 0)
+	{
+		throw std::invalid_argument("Init Values vector must have 7 values per pose");
+	}
+	num_poses_ = init_values.size() / 7;
+	position_coeff_ = position_coefficient;
+	orientation_coeff_ = orientation_coefficient;
+	interpolation_ = interpolation;
+	reset(init_values);
+}
+
+std::vector<double> BasicPoseMultiFilter::filter(const std::vector<double>& new_measurements)
+{
+	NRG_PROFILE_SCOPE("BasicPoseMultiFilter::filter");
+	if(new_measurements.size() != 7 * num_poses_)
+	{
+		throw std::out_of_range("New Measurement vector must have 7 values for each filtered pose");
+	}
+
+	// Push in the new measurement
+	positions_[1].swap(positions_[0]);
+	orientations_[1].swap(orientations_[0]);
+	split(new_measurements, positions_[0], orientations_[0]);
+
+	// Positions, same as BasicLowPassFilter
+	const double a = 1. / (1. + position_coeff_);
+	filtered_positions_ = a * (positions_[0] + positions_[1]) - a * (1. - position_coeff_) * filtered_positions_;
+
+	// Keep both measurements in the same hemisphere as the last output, so blending takes the short way around
+	for(int i=0; i<2; ++i)
+	{
+		const Eigen::ArrayXd sign = ((orientations_[i] * filtered_orientations_).rowwise().sum() < 0).select(-Eigen::ArrayXd::Ones(num_poses_), 1.);
+		orientations_[i].colwise() *= sign;
+	}
+
+	const double b = 1. / (1. + orientation_coeff_);
+	if(interpolation_ == NLERP)
+	{
+		// The same weights as the positions, then back onto the unit sphere
+		Eigen::ArrayX4d blend = b * (orientations_[0] + orientations_[1]) - b * (1. - orientation_coeff_) * filtered_orientations_;
+		blend.colwise() *= blend.square().rowwise().sum().rsqrt();
+		filtered_orientations_ = blend;
+	}
+	else
+	{
+		// The filter is the last output moved towards the midpoint of the two measurements, by a fraction t
+		Eigen::ArrayX4d midpoint = orientations_[0] + orientations_[1];
+		midpoint.colwise() *= midpoint.square().rowwise().sum().rsqrt();
+		const double t = 2. * b;
+
+		const Eigen::ArrayXd cos_angle = (midpoint * filtered_orientations_).rowwise().sum().min(1.);
+		const Eigen::ArrayXd angle = cos_angle.acos();
+		const Eigen::ArrayXd sin_angle = angle.sin();
+
+		// Nearly equal orientations fall back to linear weights, which also avoids dividing by ~0
+		const Eigen::Array<bool, Eigen::Dynamic, 1> small = sin_angle < 1e-6;
+		const Eigen::ArrayXd inv_sin = small.select(Eigen::ArrayXd::Ones(num_poses_), sin_angle.inverse());
+		const Eigen::ArrayXd w0 = small.select(1. - t, ((1. - t) * angle).sin() * inv_sin);
+		const Eigen::ArrayXd w1 = small.select(t, (t * angle).sin() * inv_sin);
+
+		Eigen::ArrayX4d blend = filtered_orientations_.colwise() * w0 + midpoint.colwise() * w1;
+		blend.colwise() *= blend.square().rowwise().sum().rsqrt();
+		filtered_orientations_ = blend;
+	}
+
+	std::vector<double> output(7 * num_poses_);
+	for(size_t i=0; i<num_poses_; ++i)
+	{
+		for(int j=0; j<3; ++j) output[7*i + j] = filtered_positions_(i, j);
+		for(int j=0; j<4; ++j) output[7*i + 3 + j] = filtered_orientations_(i, j);
+	}
+	return output;
+}
+
+void BasicPoseMultiFilter::reset(const std::vector<double>& reset_values)
+{
+	if(reset_values.size() != 7 * num_poses_)
+	{
+		throw std::out_of_range("Reset Values vector must have 7 values for each filtered pose");
+	}
+	split(reset_values, filtered_positions_, filtered_orientations_);
+	for(int i=0; i<2; ++i)
+	{
+		positions_[i] = filtered_positions_;
+		orientations_[i] = filtered_orientations_;
+	}
+}
+
+void BasicPoseMultiFilter::split(const std::vector<double>& poses, Eigen::ArrayX3d& positions, Eigen::ArrayX4d& orientations) const
+{
+	positions.resize(num_poses_, 3);
+	orientations.resize(num_poses_, 4);
+	for(size_t i=0; i<num_poses_; ++i)
+	{
+		for(int j=0; j<3; ++j) positions(i, j) = poses[7*i + j];
+		for(int j=0; j<4; ++j) orientations(i, j) = poses[7*i + 3 + j];
+	}
+
+	// An all zero quaternion (e.g. a default constructed message) is taken as the identity
+	Eigen::ArrayXd norm = orientations.square().rowwise().sum();
+	const Eigen::Array<bool, Eigen::Dynamic, 1> zero = norm < 1e-12;
+	orientations.col(3) = zero.select(1., orientations.col(3));
+	norm = zero.select(1., norm);
+	orientations.colwise() *= norm.rsqrt();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <Eigen/Core>
+
+namespace nrg_tools{
+	/**
+	 * \class BasicPoseMultiFilter
+	 * A Low Pass Filter for a vector of poses, with no ROS capabilities.
+	 * Each pose is 7 values in the conversion layout of geometry_msgs::Pose and geometry_msgs::Transform:
+	 * position (x, y, z) then orientation quaternion (x, y, z, w).
+	 *
+	 * Positions are filtered the same way as BasicLowPassFilter. Orientations are blended as unit quaternions
+	 * with the same weights, always taking the shorter way around, so the output stays unit norm and never
+	 * flips hemisphere. All poses are filtered together, one array per component
+	 */
+	class BasicPoseMultiFilter
+	{
+	public:
+		/**
+		 * How orientations are blended
+		 * NLERP: Normalized weighted sum. Cheapest, and matches SLERP closely for small changes between updates
+		 * SLERP: Blends along the great circle, for constant angular smoothing regardless of the change
+		 */
+		enum Interpolation {NLERP, SLERP};
+
+		/**
+		 * Constructor
+		 * @param position_coefficient		Higher = more smoothing, but also more lag in the data. Reccomended default = 2
+		 * @param orientation_coefficient	Same as position_coefficient, but for the orientations
+		 * @param init_values				The starting poses, 7 values per pose. Quaternions are normalized
+		 * @param interpolation				How orientations are blended
+		 */
+		BasicPoseMultiFilter(double position_coefficient, double orientation_coefficient, const std::vector<double>& init_values,
+							 Interpolation interpolation=NLERP);
+
+		/**
+		 * Updates the filter with the new measurements and returns the filtered data as a vector
+		 * @param new_measurements	The new poses to be filtered, 7 values per pose. Quaternions do not need to be normalized
+		 * @return 					The filtered poses after accounting for the newest data
+		 */
+		std::vector<double> filter(const std::vector<double>& new_measurements);
+
+		/**
+		 * Sets all of the poses to the desired values
+		 * @param reset_values	The poses to set the filter to, 7 values per pose
+		 */
+		void reset(const std::vector<double>& reset_values);
+
+		/**
+		 * Gets the number of poses this filter is tracking
+		 * @return		The number of poses
+		 */
+		size_t getNumberPoses(){return num_poses_;};
+
+	private:
+		size_t num_poses_ = 0;
+		double position_coeff_ = 1.0;
+		double orientation_coeff_ = 1.0;
+		Interpolation interpolation_ = NLERP;
+
+		// One row per pose, so each column (component) is contiguous
+		Eigen::ArrayX3d positions_[2];				// The newest and previous position measurements
+		Eigen::ArrayX3d filtered_positions_;
+		Eigen::ArrayX4d orientations_[2];			// The newest and previous orientation measurements, normalized
+		Eigen::ArrayX4d filtered_orientations_;
+
+		/**
+		 * Copies a vector of poses into the position and orientation arrays, normalizing the quaternions
+		 */
+		void split(const std::vector<double>& poses, Eigen::ArrayX3d& positions, Eigen::ArrayX4d& orientations) const;
+	};
+
+} //end nrg_tools namespace
@@ -0,0 +1,380 @@
+#pragma once
+
+/**
+ * Optional latency instrumentation for the hot paths of nrg_tools (convert, the filters and the bounds).
+ * Compiled out entirely unless NRG_TOOLS_ENABLE_PROFILING is defined before including nrg_tools,
+ * except for the clock functions, which are also used to time single calls (e.g. by src/bag_benchmark.cpp).
+ *
+ * When enabled, every instrumented call is counted, and one call in NRG_TOOLS_PROFILING_SAMPLE_PERIOD
+ * reads the time stamp counter on entry and exit and adds the difference to a histogram owned by the
+ * calling thread, so nothing is shared or locked on the hot path. Reading the counter is the main cost
+ * (~25 cycles each, more on virtual machines), so sampling keeps the average cost of a scope to a few ns.
+ * getProfilingReport() merges the histograms of all threads on demand.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace nrg_tools{
+namespace profiling{
+
+	/**
+	 * Reads the time stamp counter, or a nanosecond clock on other architectures
+	 */
+	inline uint64_t readTicks()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	/**
+	 * Measures the number of ticks per nanosecond. Done once, the first time it is called
+	 */
+	inline double ticksPerNanosecond()
+	{
+		static const double ticks_per_ns = []()
+		{
+			const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+			const uint64_t start_ticks = readTicks();
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			const uint64_t end_ticks = readTicks();
+			const double elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count();
+			return (end_ticks - start_ticks) / elapsed_ns;
+		}();
+		return ticks_per_ns;
+	}
+
+	/**
+	 * Measures the cost of timing nothing, i.e. of the two readTicks() calls around a timed call. Done once
+	 * @return 		The median ticks between two back to back reads, to subtract from measured times
+	 */
+	inline uint64_t timerOverheadTicks()
+	{
+		static const uint64_t overhead = []()
+		{
+			std::vector<uint64_t> samples(10001);
+			for(size_t i=0; i<samples.size(); ++i)
+			{
+				const uint64_t start = readTicks();
+				samples[i] = readTicks() - start;
+			}
+			std::nth_element(samples.begin(), samples.begin() + samples.size()/2, samples.end());
+			return samples[samples.size()/2];
+		}();
+		return overhead;
+	}
+
+} // end profiling namespace
+} // end nrg_tools namespace
+
+#ifdef NRG_TOOLS_ENABLE_PROFILING
+
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+// Time one in this many calls of each site (a power of two). 1 times every call
+#ifndef NRG_TOOLS_PROFILING_SAMPLE_PERIOD
+#define NRG_TOOLS_PROFILING_SAMPLE_PERIOD 8
+#endif
+
+#define NRG_PROFILE_CONCAT_INNER(a, b) a##b
+#define NRG_PROFILE_CONCAT(a, b) NRG_PROFILE_CONCAT_INNER(a, b)
+
+/**
+ * Times the rest of the enclosing scope under the given name (a string literal)
+ */
+#define NRG_PROFILE_SCOPE(name) \
+	static const int NRG_PROFILE_CONCAT(nrg_profile_site_, __LINE__) = nrg_tools::profiling::registerSite(name); \
+	nrg_tools::profiling::ScopedTimer NRG_PROFILE_CONCAT(nrg_profile_timer_, __LINE__)(NRG_PROFILE_CONCAT(nrg_profile_site_, __LINE__))
+
+namespace nrg_tools{
+namespace profiling{
+
+	// Histogram buckets are log-linear: 8 buckets per power of two, so percentiles are within ~6%
+	const int kSubBucketBits = 3;
+	const int kNumBuckets = 64 << kSubBucketBits;
+	const int kMaxSites = 32;
+	const uint64_t kSamplePeriod = NRG_TOOLS_PROFILING_SAMPLE_PERIOD;
+	static_assert(kSamplePeriod > 0 && (kSamplePeriod & (kSamplePeriod - 1)) == 0, "The sample period must be a power of two");
+
+	/**
+	 * The latency statistics of one instrumented call site, merged over all threads
+	 */
+	struct SiteStats
+	{
+		std::string name;
+		uint64_t count;			// Every call, not only the timed ones
+		double p50_ns;
+		double p99_ns;
+		double max_ns;
+	};
+
+	/**
+	 * Histogram of the timed calls of one call site for one thread. Only the owning thread writes to it,
+	 * so updates are relaxed loads and stores rather than atomic read-modify-writes
+	 */
+	struct Histogram
+	{
+		std::atomic<uint64_t> buckets[kNumBuckets];
+		std::atomic<uint64_t> max_ticks;
+		std::atomic<uint64_t> calls;
+
+		Histogram()
+		{
+			for(int i=0; i<kNumBuckets; ++i) buckets[i].store(0, std::memory_order_relaxed);
+			max_ticks.store(0, std::memory_order_relaxed);
+			calls.store(0, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Counts a call
+		 * @return		'true' if this call should be timed
+		 */
+		bool count()
+		{
+			const uint64_t previous = calls.load(std::memory_order_relaxed);
+			calls.store(previous + 1, std::memory_order_relaxed);
+			return (previous & (kSamplePeriod - 1)) == 0;
+		}
+
+		static int bucketIndex(const uint64_t ticks)
+		{
+			if(ticks < (1u << kSubBucketBits)) return ticks;
+			const int log2 = 63 - __builtin_clzll(ticks);
+			const int sub_bucket = (ticks >> (log2 - kSubBucketBits)) & ((1 << kSubBucketBits) - 1);
+			return ((log2 - kSubBucketBits + 1) << kSubBucketBits) + sub_bucket;
+		}
+
+		static uint64_t bucketLowerBound(const int index)
+		{
+			if(index < (1 << kSubBucketBits)) return index;
+			const int log2 = (index >> kSubBucketBits) + kSubBucketBits - 1;
+			const uint64_t sub_bucket = index & ((1 << kSubBucketBits) - 1);
+			return (uint64_t(1) << log2) + (sub_bucket << (log2 - kSubBucketBits));
+		}
+
+		void record(const uint64_t ticks)
+		{
+			std::atomic<uint64_t>& bucket = buckets[bucketIndex(ticks)];
+			bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			if(ticks > max_ticks.load(std::memory_order_relaxed)) max_ticks.store(ticks, std::memory_order_relaxed);
+		}
+	};
+
+	/**
+	 * The histograms of all sites for one thread. When the thread exits they are handed to the next new thread,
+	 * so the data of finished threads is still reported, and only as many exist as threads ever ran at once
+	 */
+	struct ThreadHistograms
+	{
+		Histogram sites[kMaxSites];
+	};
+
+	/**
+	 * Global list of site names and of the histograms of every thread that recorded anything
+	 */
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<std::string> site_names;
+		std::vector<ThreadHistograms*> threads;
+		std::vector<ThreadHistograms*> unused;		// Released by threads that exited
+
+		static Registry& instance()
+		{
+			static Registry registry;
+			return registry;
+		}
+	};
+
+	/**
+	 * Registers an instrumented call site. Called once per site by NRG_PROFILE_SCOPE
+	 * @param name		The name to report the site under. Sites with the same name are merged
+	 * @return			The index of the site, or -1 if there are already kMaxSites sites
+	 */
+	inline int registerSite(const char* name)
+	{
+		Registry& registry = Registry::instance();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		std::vector<std::string>::iterator it = std::find(registry.site_names.begin(), registry.site_names.end(), name);
+		if(it != registry.site_names.end()) return it - registry.site_names.begin();
+		if((int)registry.site_names.size() >= kMaxSites) return -1;
+		registry.site_names.push_back(name);
+		return registry.site_names.size() - 1;
+	}
+
+	/**
+	 * The histograms used by the calling thread. A plain pointer, so reading it needs no initialization check
+	 */
+	inline ThreadHistograms*& currentHistograms()
+	{
+		static thread_local ThreadHistograms* histograms = NULL;
+		return histograms;
+	}
+
+	/**
+	 * Releases the calling thread's histograms when it exits, for the next new thread to use
+	 */
+	struct ThreadHistogramsOwner
+	{
+		~ThreadHistogramsOwner()
+		{
+			ThreadHistograms*& histograms = currentHistograms();
+			if(histograms == NULL) return;
+			Registry& registry = Registry::instance();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			registry.unused.push_back(histograms);
+			histograms = NULL;
+		}
+	};
+
+	/**
+	 * Gets the histograms of the calling thread, taking unused ones or registering new ones on first use
+	 */
+	inline ThreadHistograms& threadHistograms()
+	{
+		ThreadHistograms*& histograms = currentHistograms();
+		if(histograms == NULL)
+		{
+			static thread_local ThreadHistogramsOwner owner;
+			(void)owner;
+			Registry& registry = Registry::instance();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			if(!registry.unused.empty())
+			{
+				histograms = registry.unused.back();
+				registry.unused.pop_back();
+			}
+			else
+			{
+				histograms = new ThreadHistograms();
+				registry.threads.push_back(histograms);
+			}
+		}
+		return *histograms;
+	}
+
+	/**
+	 * \class ScopedTimer
+	 * Counts a call, and records the time between its construction and destruction if the call is sampled.
+	 * Use through NRG_PROFILE_SCOPE
+	 */
+	class ScopedTimer
+	{
+	public:
+		explicit ScopedTimer(const int site)
+		{
+			if(site < 0) return;
+			Histogram& histogram = threadHistograms().sites[site];
+			if(histogram.count())
+			{
+				histogram_ = &histogram;
+				start_ = readTicks();
+			}
+		}
+
+		~ScopedTimer()
+		{
+			if(histogram_) histogram_->record(readTicks() - start_);
+		}
+
+	private:
+		Histogram* histogram_ = NULL;
+		uint64_t start_ = 0;
+	};
+
+	/**
+	 * Merges the histograms of all threads into percentiles per call site. The percentiles and max are of the
+	 * sampled calls, so a rare spike can be missed unless NRG_TOOLS_PROFILING_SAMPLE_PERIOD is 1.
+	 * Safe to call while the instrumented code is running
+	 * @return 		The statistics of every site that has recorded at least one call
+	 */
+	inline std::vector<SiteStats> getProfilingReport()
+	{
+		const double ticks_per_ns = ticksPerNanosecond();
+		Registry& registry = Registry::instance();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		std::vector<SiteStats> output;
+		std::vector<uint64_t> merged(kNumBuckets);
+		for(size_t site=0; site<registry.site_names.size(); ++site)
+		{
+			std::fill(merged.begin(), merged.end(), 0);
+			uint64_t count = 0, calls = 0, max_ticks = 0;
+			for(size_t t=0; t<registry.threads.size(); ++t)
+			{
+				const Histogram& histogram = registry.threads[t]->sites[site];
+				for(int i=0; i<kNumBuckets; ++i)
+				{
+					const uint64_t bucket = histogram.buckets[i].load(std::memory_order_relaxed);
+					merged[i] += bucket;
+					count += bucket;
+				}
+				calls += histogram.calls.load(std::memory_order_relaxed);
+				max_ticks = std::max(max_ticks, histogram.max_ticks.load(std::memory_order_relaxed));
+			}
+			if(count == 0) continue;
+
+			SiteStats stats;
+			stats.name = registry.site_names[site];
+			stats.count = calls;
+			stats.max_ns = max_ticks / ticks_per_ns;
+			stats.p50_ns = stats.p99_ns = stats.max_ns;
+			uint64_t cumulative = 0;
+			bool found_p50 = false;
+			for(int i=0; i<kNumBuckets; ++i)
+			{
+				cumulative += merged[i];
+				if(!found_p50 && 2*cumulative >= count)
+				{
+					stats.p50_ns = Histogram::bucketLowerBound(i) / ticks_per_ns;
+					found_p50 = true;
+				}
+				if(100*cumulative >= 99*count)
+				{
+					stats.p99_ns = Histogram::bucketLowerBound(i) / ticks_per_ns;
+					break;
+				}
+			}
+			output.push_back(stats);
+		}
+		return output;
+	}
+
+	/**
+	 * Gets the profiling report as a table for printing
+	 * @return 		One line per call site with the number of calls, p50, p99 and max in nanoseconds
+	 */
+	inline std::string getProfilingReportStr()
+	{
+		const std::vector<SiteStats> report = getProfilingReport();
+		std::stringstream stringstream;
+		stringstream << std::fixed << std::setprecision(1);
+		for(size_t i=0; i<report.size(); ++i)
+		{
+			stringstream << report[i].name << ": " << report[i].count << " calls, p50 " << report[i].p50_ns
+				<< " ns, p99 " << report[i].p99_ns << " ns, max " << report[i].max_ns << " ns\n";
+		}
+		return stringstream.str();
+	}
+
+} // end profiling namespace
+} // end nrg_tools namespace
+
+#else
+
+#define NRG_PROFILE_SCOPE(name)
+
+#endif
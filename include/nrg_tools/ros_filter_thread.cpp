@@ -0,0 +1,148 @@
+#pragma once
+
+#include <conversions.hpp>
+#include <basic_lowpass_filters.cpp>
+#include <spsc_ring.hpp>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace nrg_tools{
+
+/**
+ * \class RosFilterThread
+ * Moves low pass filtering of ROS message types off of the subscriber callbacks and onto a dedicated thread.
+ * Callbacks only convert the message and push it into a SpscSampleRing. The filter thread wakes up once
+ * per period, filters every sample that arrived since the last wake up as one batch, and hands the
+ * newest filtered message to a callback. Fields that are not filtered (e.g. headers) come from the newest
+ * pushed message the filter thread has seen
+ */
+template<typename T>
+class RosFilterThread
+{
+public:
+	/**
+	 * Constructor. Starts the filter thread
+	 * @param filter_coefficients	Higher = more smoothing, but also more lag in the data. Reccomended default = 2
+	 * @param init_value			The starting value of the filter. Must be the message type you want to filter later
+	 * @param output_callback		Called from the filter thread with the newest filtered message, after each batch
+	 * @param period				How long the filter thread sleeps between batches
+	 * @param capacity				The most messages that can wait for the filter thread. Extra messages are dropped
+	 */
+	RosFilterThread<T>(T filter_coefficients, T init_value, std::function<void(const T&)> output_callback,
+					   std::chrono::microseconds period=std::chrono::microseconds(1000), size_t capacity=256);
+
+	/**
+	 * Destructor. Stops the filter thread after it finishes its current batch
+	 */
+	~RosFilterThread<T>();
+
+	/**
+	 * Queues a new measurement for the filter thread. Call from a single thread (e.g. one subscriber callback).
+	 * The message is converted straight into the queue, so fixed size types do not allocate
+	 * @param new_measurement	The new data to be filtered, in ROS message form. Must have the size of the init value
+	 * @return 					'true' if it was queued, 'false' if the queue was full and it was dropped
+	 */
+	bool push(const T& new_measurement);
+
+	/**
+	 * Gets the number of messages waiting for the filter thread
+	 * @return		The backlog
+	 */
+	size_t getBacklog() const {return ring_.getBacklog();};
+
+	/**
+	 * Gets the largest batch the filter thread has processed
+	 * @return		The highest backlog seen by the filter thread
+	 */
+	size_t getMaxBacklog() const {return ring_.getMaxBacklog();};
+
+	/**
+	 * Gets the number of messages dropped because the filter thread fell behind
+	 * @return		The number of overruns
+	 */
+	size_t getOverruns() const {return ring_.getOverruns();};
+
+private:
+	BasicLowPassMultiFilter* multifilter_;
+	SpscSampleRing ring_;
+	T output_;
+	T latest_;					// The newest pushed message, for the fields that are not filtered
+	std::mutex latest_mutex_;
+	std::function<void(const T&)> output_callback_;
+	std::chrono::microseconds period_;
+	std::atomic<bool> running_;
+	std::thread thread_;
+
+	/**
+	 * The filter thread's loop
+	 */
+	void run();
+};
+
+template<typename T>
+RosFilterThread<T>::RosFilterThread(T filter_coefficients, T init_value, std::function<void(const T&)> output_callback,
+									std::chrono::microseconds period, size_t capacity)
+ : ring_(nrg_conversions::toVec(init_value).size(), capacity), output_(init_value), latest_(init_value), output_callback_(output_callback),
+   period_(period), running_(true)
+{
+	std::vector<double> coeff_vector, init_vector;
+	convert(filter_coefficients, coeff_vector);
+	convert(init_value, init_vector);
+	multifilter_ = new BasicLowPassMultiFilter(coeff_vector, init_vector);
+	thread_ = std::thread(&RosFilterThread<T>::run, this);
+}
+
+template<typename T>
+RosFilterThread<T>::~RosFilterThread()
+{
+	running_ = false;
+	thread_.join();
+	delete multifilter_;
+}
+
+template<typename T>
+bool RosFilterThread<T>::push(const T& new_measurement)
+{
+	double* slot = ring_.claim();
+	if(!slot) return false;
+	if(!convert(new_measurement, Eigen::Map<Eigen::VectorXd>(slot, ring_.getSampleSize())))
+	{
+		throw std::invalid_argument("Measurement size does not match the init value");
+	}
+
+	// Never waits for the filter thread. If it is reading, the next message's fields are used instead
+	if(latest_mutex_.try_lock())
+	{
+		latest_ = new_measurement;
+		latest_mutex_.unlock();
+	}
+	ring_.commit();
+	return true;
+}
+
+template<typename T>
+void RosFilterThread<T>::run()
+{
+	const size_t sample_size = ring_.getSampleSize();
+	std::vector<double> batch(ring_.getCapacity() * sample_size), newest(sample_size);
+	while(running_)
+	{
+		const size_t count = ring_.drain(batch.data(), ring_.getCapacity());
+		if(count > 0)
+		{
+			multifilter_->filterBatch(batch.data(), count);
+			newest.assign(batch.begin() + (count - 1)*sample_size, batch.begin() + count*sample_size);
+			{
+				std::lock_guard<std::mutex> lock(latest_mutex_);
+				output_ = latest_;
+			}
+			convert(newest, output_);
+			if(output_callback_) output_callback_(output_);
+		}
+		std::this_thread::sleep_for(period_);
+	}
+}
+
+} // end nrg_tools namespace
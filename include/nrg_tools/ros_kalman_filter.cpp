@@ -0,0 +1,93 @@
+#pragma once
+
+#include <conversions.hpp>
+#include <kalman_filters.cpp>
+
+namespace nrg_tools{
+
+/**
+ * \class RosKalmanFilter
+ * A Kalman filter bank for ROS message types, estimating each converted value and its derivatives
+ * (e.g. the velocity of a PoseStamped position). Order = 2 for constant velocity and 3 for constant acceleration models
+ */
+template<typename T, int Order=2>
+class RosKalmanFilter
+{
+public:
+	/**
+	 * Constructor
+	 * @param init_value			The starting value of the filter. Must be the message type you want to filter later
+	 * @param time_step				The time between messages
+	 * @param process_noise			Per value, the spectral density of the noise driving the highest derivative. Must be positive with steady-state gains
+	 * @param measurement_noise		Per value, the variance of the measurements
+	 * @param steady_state			If 'true', use fixed gains, computed once, instead of updating the covariance
+	 */
+	RosKalmanFilter(T init_value, double time_step, T process_noise, T measurement_noise, bool steady_state=false);
+
+	/**
+	 * Updates the filter with the new measurement and returns the filtered data
+	 * @param new_measurement	The new data to be filtered, in ROS message form
+	 * @return 					The estimated values as a ROS message
+	 */
+	T filter(const T new_measurement);
+
+	/**
+	 * Gets a derivative of the estimate, in the form of the message (e.g. the velocity of each value)
+	 * @param derivative	1 for velocities, 2 for accelerations (Order = 3 only)
+	 * @param output		The derivatives. Fields that are not filtered (e.g. headers) are kept
+	 */
+	void getDerivative(const int derivative, T& output) const;
+
+	/**
+	 * Sets the filter to a desired value
+	 * @param reset_value	Resets the filter to match this ROS message
+	 */
+	void reset(const T reset_value);
+
+private:
+	BasicKalmanMultiFilter<Order>* multifilter_;
+};
+
+template<typename T, int Order>
+RosKalmanFilter<T, Order>::RosKalmanFilter(T init_value, double time_step, T process_noise, T measurement_noise, bool steady_state)
+{
+	// Convert to std::vector's and feed into a basic multi filter
+	std::vector<double> init_vector, process_vector, measurement_vector;
+	convert(init_value, init_vector);
+	convert(process_noise, process_vector);
+	convert(measurement_noise, measurement_vector);
+	multifilter_ = new BasicKalmanMultiFilter<Order>(time_step, process_vector, measurement_vector, init_vector, steady_state);
+}
+
+template<typename T, int Order>
+T RosKalmanFilter<T, Order>::filter(const T new_measurement)
+{
+	NRG_PROFILE_SCOPE("RosKalmanFilter::filter");
+	std::vector<double> measurement_data, filtered_data;
+	convert(new_measurement, measurement_data);
+	filtered_data = multifilter_->filter(measurement_data);
+
+	// Convert to the output type and return, keeping any fields that are not filtered
+	T output = new_measurement;
+	convert(filtered_data, output);
+	return output;
+}
+
+template<typename T, int Order>
+void RosKalmanFilter<T, Order>::getDerivative(const int derivative, T& output) const
+{
+	std::vector<double> derivative_data;
+	multifilter_->getState(derivative, derivative_data);
+	convert(derivative_data, output);
+}
+
+template<typename T, int Order>
+void RosKalmanFilter<T, Order>::reset(const T reset_value)
+{
+	// Convert to a std::vector and feed into multi filter
+	std::vector<double> reset_vector;
+	convert(reset_value, reset_vector);
+	multifilter_->reset(reset_vector);
+}
+
+} // end nrg_tools namespace
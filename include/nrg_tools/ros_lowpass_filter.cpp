@@ -2,6 +2,7 @@
 
 #include <conversions.hpp>
 #include <basic_lowpass_filters.cpp>
+#include <stdexcept>
 
 namespace nrg_tools{
 
@@ -9,17 +10,20 @@ namespace nrg_tools{
  * \class RosLowPassFilter
  * A Low Pass filter for ROS message types. 
  * Useful for filtering sensor feedback (e.g. IMU, Force/Torque sensors, etc)
- * directly from subscribers
+ * directly from subscribers. Selection filters only some of the fields (e.g. fields::Force of a WrenchStamped),
+ * and the others are passed through. The selected values are filtered in a buffer kept between calls,
+ * so filtering fixed size types (e.g. geometry_msgs) does not allocate
  */
-template<typename T>
+template<typename T, class Selection=fields::All>
 class RosLowPassFilter
 {
 public:
 	/**
 	 * Constructor
-	 * @param filter_coefficients	The coefficients of the filters. Must be the message type you want to filter later. Higher values = more smoothing but more lag
+	 * @param filter_coefficients	The coefficients of the filters. Must be the message type you want to filter later. Higher values = more smoothing but more lag.
+	 *								Only the coefficients of the selected fields are used
 	 */
-	RosLowPassFilter<T>(T filter_coefficients);
+	RosLowPassFilter(T filter_coefficients);
 
 	/**
 	 * Updates the filter with the new measurement and returns the filtered data
@@ -34,42 +38,70 @@ public:
 	 */
 	void reset(const T reset_value);
 
+	/**
+	 * Gets the number of values in the internal state of the filter
+	 * @return		The state size
+	 */
+	size_t getStateSize() const {return multifilter_->getStateSize();};
+
+	/**
+	 * Copies the internal state of the filter (e.g. into a FilterSnapshot), so it can be restored after a restart
+	 * @param state		Filled with getStateSize() values
+	 */
+	void getState(double* state) const {multifilter_->getState(state);};
+
+	/**
+	 * Sets the internal state of the filter, so filtering continues without settling from a reset value
+	 * @param state		getStateSize() values, from getState()
+	 */
+	void setState(const double* state) {multifilter_->setState(state);};
+
 private:
 	BasicLowPassMultiFilter* multifilter_;
+	std::vector<double> selected_;
 };
 
-template<typename T>
-RosLowPassFilter<T>::RosLowPassFilter(T filter_coefficients)
+template<typename T, class Selection>
+RosLowPassFilter<T, Selection>::RosLowPassFilter(T filter_coefficients)
 {
 	// Convert to std::vector's
 	std::vector<double> coeff_vector, inital_vector;
-	convert(filter_coefficients, coeff_vector);
+	if(!extractFields<Selection>(filter_coefficients, coeff_vector))
+	{
+		throw std::invalid_argument("Selected fields are outside of the message");
+	}
 
 	// Feed into a basic multi filter
 	inital_vector.assign(coeff_vector.size(), 0.0);
 	multifilter_ = new BasicLowPassMultiFilter(coeff_vector, inital_vector);
+	selected_.resize(coeff_vector.size());
 }
 
-template<typename T>
-T RosLowPassFilter<T>::filter(const T new_measurement)
+template<typename T, class Selection>
+T RosLowPassFilter<T, Selection>::filter(const T new_measurement)
 {
-	// Convert to a std::vector and feed into multi filter
-	std::vector<double> measurement_data, filtered_data;
-	convert(new_measurement, measurement_data);
-	filtered_data = multifilter_->filter(measurement_data);
+	NRG_PROFILE_SCOPE("RosLowPassFilter::filter");
+	// Convert into the kept buffer and filter it in place
+	extractFields<Selection>(new_measurement, selected_);
+	if(selected_.size() != multifilter_->getNumberFilters())
+	{
+		throw std::out_of_range("New Measurement vector must be same size as the number of filters");
+	}
+	multifilter_->filterBatch(selected_.data(), 1);
 
-	// Convert to the output type and return
-	T output;
-	convert(filtered_data, output);
+	// Convert to the output type and return. Starting from the measurement keeps
+	// the fields that are not filtered, like headers, joint names and unselected fields
+	T output = new_measurement;
+	writeFields<Selection>(selected_, output);
 	return output;
 }
 
-template<typename T>
-void RosLowPassFilter<T>::reset(const T reset_value)
+template<typename T, class Selection>
+void RosLowPassFilter<T, Selection>::reset(const T reset_value)
 {
 	// Convert to a std::vector and feed into multi filter
 	std::vector<double> reset_vector;
-	convert(reset_value, reset_vector);
+	extractFields<Selection>(reset_value, reset_vector);
 	multifilter_->reset(reset_vector);
 }
 
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <conversions.hpp>
+#include <median_filters.cpp>
+
+namespace nrg_tools{
+
+/**
+ * \class RosMedianFilter
+ * A sliding window median (or Hampel) filter for ROS message types.
+ * Useful for removing spikes from sensor feedback (e.g. Force/Torque sensors)
+ * directly from subscribers
+ */
+template<typename T>
+class RosMedianFilter
+{
+public:
+	/**
+	 * Constructor
+	 * @param init_value			The starting value of the filter. Must be the message type you want to filter later
+	 * @param window_size			The number of measurements the median is taken over. Odd sizes are reccomended
+	 * @param hampel_threshold		If greater than 0, only measurements this many standard deviations from the median are replaced
+	 */
+	RosMedianFilter<T>(T init_value, int window_size, double hampel_threshold=0.0);
+
+	/**
+	 * Updates the filter with the new measurement and returns the filtered data
+	 * @param new_measurement	The new data to be filtered, in ROS message form
+	 * @return 					The filtered measurement as a ROS message
+	 */
+	T filter(const T new_measurement);
+
+	/**
+	 * Sets the filter to a desired value
+	 * @param reset_value	Resets the filter to match this ROS message
+	 */
+	void reset(const T reset_value);
+
+private:
+	BasicMedianMultiFilter* multifilter_;
+};
+
+template<typename T>
+RosMedianFilter<T>::RosMedianFilter(T init_value, int window_size, double hampel_threshold)
+{
+	std::vector<double> init_vector;
+	convert(init_value, init_vector);
+	multifilter_ = new BasicMedianMultiFilter(window_size, init_vector, hampel_threshold);
+}
+
+template<typename T>
+T RosMedianFilter<T>::filter(const T new_measurement)
+{
+	// Convert to a std::vector and feed into multi filter
+	std::vector<double> measurement_data, filtered_data;
+	convert(new_measurement, measurement_data);
+	filtered_data = multifilter_->filter(measurement_data);
+
+	// Convert to the output type and return, keeping any fields that are not filtered
+	T output = new_measurement;
+	convert(filtered_data, output);
+	return output;
+}
+
+template<typename T>
+void RosMedianFilter<T>::reset(const T reset_value)
+{
+	// Convert to a std::vector and feed into multi filter
+	std::vector<double> reset_vector;
+	convert(reset_value, reset_vector);
+	multifilter_->reset(reset_vector);
+}
+
+} // end nrg_tools namespace
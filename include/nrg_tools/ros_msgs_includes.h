@@ -30,6 +30,15 @@
 #include <geometry_msgs/Wrench.h>
 #include <geometry_msgs/WrenchStamped.h>
 
+// ~~~~~~~~~~~~~~~ Sensor Msgs ~~~~~~~~~~~~~~~~~
+#include <sensor_msgs/JointState.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <sensor_msgs/PointField.h>
+
+// ~~~~~~~~~~~~~~~ Trajectory Msgs ~~~~~~~~~~~~~~~~~
+#include <trajectory_msgs/JointTrajectory.h>
+#include <trajectory_msgs/JointTrajectoryPoint.h>
+
 // ~~~~~~~~~~~~~~~ Tf Msgs ~~~~~~~~~~~~~~~~~
 #include <tf/transform_datatypes.h>
 #include <tf2/LinearMath/Quaternion.h>
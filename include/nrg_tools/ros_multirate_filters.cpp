@@ -0,0 +1,149 @@
+#pragma once
+
+#include <conversions.hpp>
+#include <multirate_filters.cpp>
+
+namespace nrg_tools{
+
+/**
+ * \class RosDecimatingFilter
+ * A decimating low pass filter for ROS message types.
+ * Useful for bringing high rate sensor feedback (e.g. Force/Torque sensors) down to the controller rate
+ */
+template<typename T>
+class RosDecimatingFilter
+{
+public:
+	/**
+	 * Constructor
+	 * @param init_value		The starting value of the filter. Must be the message type you want to filter later
+	 * @param factor			The ratio of input rate to output rate
+	 * @param taps_per_output	Length of the FIR filter in output samples. Higher = sharper cutoff, but more lag
+	 */
+	RosDecimatingFilter<T>(T init_value, int factor, int taps_per_output=8);
+
+	/**
+	 * Adds a new measurement, and computes an output if one is due
+	 * @param new_measurement	The new data to be filtered, in ROS message form
+	 * @param output			The filtered measurement as a ROS message. Only written when the function returns 'true'
+	 * @return 					'true' on every factor-th call, when a new output was computed
+	 */
+	bool filter(const T& new_measurement, T& output);
+
+	/**
+	 * Sets the filter to a desired value
+	 * @param reset_value	Resets the filter to match this ROS message
+	 */
+	void reset(const T reset_value);
+
+private:
+	BasicDecimatingMultiFilter* multifilter_;
+	std::vector<double> measurement_data_, filtered_data_;
+};
+
+template<typename T>
+RosDecimatingFilter<T>::RosDecimatingFilter(T init_value, int factor, int taps_per_output)
+{
+	std::vector<double> init_vector;
+	convert(init_value, init_vector);
+	multifilter_ = new BasicDecimatingMultiFilter(factor, init_vector, taps_per_output);
+}
+
+template<typename T>
+bool RosDecimatingFilter<T>::filter(const T& new_measurement, T& output)
+{
+	convert(new_measurement, measurement_data_);
+	if(!multifilter_->filter(measurement_data_, filtered_data_)) return false;
+
+	// Starting from the measurement keeps the fields that are not filtered, like headers
+	output = new_measurement;
+	convert(filtered_data_, output);
+	return true;
+}
+
+template<typename T>
+void RosDecimatingFilter<T>::reset(const T reset_value)
+{
+	std::vector<double> reset_vector;
+	convert(reset_value, reset_vector);
+	multifilter_->reset(reset_vector);
+}
+
+/**
+ * \class RosInterpolatingFilter
+ * An interpolating filter for ROS message types.
+ * Useful for bringing low rate commands up to the rate of a controller
+ */
+template<typename T>
+class RosInterpolatingFilter
+{
+public:
+	/**
+	 * Constructor
+	 * @param init_value		The starting value of the filter. Must be the message type you want to filter later
+	 * @param factor			The ratio of output rate to input rate
+	 * @param taps_per_input	Length of each polyphase branch in input samples. Higher = smoother, but more lag
+	 */
+	RosInterpolatingFilter<T>(T init_value, int factor, int taps_per_input=4);
+
+	/**
+	 * Adds a new low rate measurement. The next factor calls to next() interpolate up to it
+	 * @param new_measurement	The new data, in ROS message form
+	 */
+	void push(const T& new_measurement);
+
+	/**
+	 * Gets the next high rate output. Fields that are not interpolated (e.g. headers)
+	 * are copied from the last measurement
+	 * @return 		The interpolated data as a ROS message
+	 */
+	T next();
+
+	/**
+	 * Sets the filter to a desired value
+	 * @param reset_value	Resets the filter to match this ROS message
+	 */
+	void reset(const T reset_value);
+
+private:
+	BasicInterpolatingMultiFilter* multifilter_;
+	T last_measurement_;
+	std::vector<double> measurement_data_, interpolated_data_;
+};
+
+template<typename T>
+RosInterpolatingFilter<T>::RosInterpolatingFilter(T init_value, int factor, int taps_per_input)
+{
+	std::vector<double> init_vector;
+	convert(init_value, init_vector);
+	multifilter_ = new BasicInterpolatingMultiFilter(factor, init_vector, taps_per_input);
+	last_measurement_ = init_value;
+}
+
+template<typename T>
+void RosInterpolatingFilter<T>::push(const T& new_measurement)
+{
+	convert(new_measurement, measurement_data_);
+	multifilter_->push(measurement_data_);
+	last_measurement_ = new_measurement;
+}
+
+template<typename T>
+T RosInterpolatingFilter<T>::next()
+{
+	multifilter_->next(interpolated_data_);
+	T output = last_measurement_;
+	convert(interpolated_data_, output);
+	return output;
+}
+
+template<typename T>
+void RosInterpolatingFilter<T>::reset(const T reset_value)
+{
+	std::vector<double> reset_vector;
+	convert(reset_value, reset_vector);
+	multifilter_->reset(reset_vector);
+	last_measurement_ = reset_value;
+}
+
+} // end nrg_tools namespace
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <conversions.hpp>
+#include <pose_filters.cpp>
+
+namespace nrg_tools{
+
+/**
+ * \class RosPoseFilter
+ * A Low Pass Filter for ROS pose types (geometry_msgs::Pose, Transform, and their Stamped versions)
+ * that keeps the orientation a unit quaternion. Use instead of RosLowPassFilter, which filters
+ * each quaternion component separately
+ */
+template<typename T>
+class RosPoseFilter
+{
+public:
+	/**
+	 * Constructor
+	 * @param init_value				The starting value of the filter. Must be the message type you want to filter later
+	 * @param position_coefficient		Higher = more smoothing, but also more lag in the data. Reccomended default = 2
+	 * @param orientation_coefficient	Same as position_coefficient, but for the orientation
+	 * @param interpolation				How orientations are blended
+	 */
+	RosPoseFilter<T>(T init_value, double position_coefficient, double orientation_coefficient,
+					 BasicPoseMultiFilter::Interpolation interpolation=BasicPoseMultiFilter::NLERP);
+
+	/**
+	 * Updates the filter with the new measurement and returns the filtered data
+	 * @param new_measurement	The new data to be filtered, in ROS message form
+	 * @return 					The filtered measurement as a ROS message
+	 */
+	T filter(const T new_measurement);
+
+	/**
+	 * Sets the filter to a desired value
+	 * @param reset_value	Resets the filter to match this ROS message
+	 */
+	void reset(const T reset_value);
+
+private:
+	BasicPoseMultiFilter* multifilter_;
+};
+
+template<typename T>
+RosPoseFilter<T>::RosPoseFilter(T init_value, double position_coefficient, double orientation_coefficient,
+								BasicPoseMultiFilter::Interpolation interpolation)
+{
+	std::vector<double> init_vector;
+	convert(init_value, init_vector);
+	multifilter_ = new BasicPoseMultiFilter(position_coefficient, orientation_coefficient, init_vector, interpolation);
+}
+
+template<typename T>
+T RosPoseFilter<T>::filter(const T new_measurement)
+{
+	// Convert to a std::vector and feed into multi filter
+	std::vector<double> measurement_data, filtered_data;
+	convert(new_measurement, measurement_data);
+	filtered_data = multifilter_->filter(measurement_data);
+
+	// Convert to the output type and return, keeping any fields that are not filtered
+	T output = new_measurement;
+	convert(filtered_data, output);
+	return output;
+}
+
+template<typename T>
+void RosPoseFilter<T>::reset(const T reset_value)
+{
+	// Convert to a std::vector and feed into multi filter
+	std::vector<double> reset_vector;
+	convert(reset_value, reset_vector);
+	multifilter_->reset(reset_vector);
+}
+
+} // end nrg_tools namespace
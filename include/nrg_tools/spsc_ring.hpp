@@ -0,0 +1,182 @@
+#pragma once
+
+/**
+ * Lock free handoff of fixed-size samples from one thread (e.g. a ROS subscriber callback)
+ * to another (e.g. a filter or control thread)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace nrg_tools{
+
+	/**
+	 * \class SpscSampleRing
+	 * A bounded single producer, single consumer ring of samples, each a fixed number of doubles.
+	 * Exactly one thread may call push() (or claim() and commit()) and exactly one other thread may call drain().
+	 * Neither side blocks or allocates: when the ring is full new samples are dropped and counted as overruns
+	 */
+	class SpscSampleRing
+	{
+	public:
+		/**
+		 * Constructor
+		 * @param sample_size		The number of values in each sample
+		 * @param capacity			The maximum number of samples waiting to be drained. Rounded up to a power of 2
+		 */
+		SpscSampleRing(size_t sample_size, size_t capacity);
+
+		/**
+		 * Adds a sample. Only call from the producer thread
+		 * @param sample	The values to add, of length sample_size
+		 * @return 			'true' if the sample was added, 'false' if the ring was full and it was dropped
+		 */
+		bool push(const double* sample);
+
+		/**
+		 * Adds a sample. Only call from the producer thread
+		 * @param sample	The values to add, must be of length sample_size
+		 * @return 			'true' if the sample was added, 'false' if the ring was full and it was dropped
+		 */
+		bool push(const std::vector<double>& sample);
+
+		/**
+		 * Gets the slot of the next sample, so it can be written in place (e.g. converted into) instead of copied.
+		 * The sample is only added by commit(). Only call from the producer thread
+		 * @return 			The sample_size values of the slot, or nullptr if the ring is full (counted as an overrun)
+		 */
+		double* claim();
+
+		/**
+		 * Adds the sample written into the slot from claim(). Only call from the producer thread
+		 */
+		void commit() {head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);};
+
+		/**
+		 * Removes every waiting sample (up to max_samples), oldest first. Only call from the consumer thread
+		 * @param output		The samples, back to back. Must have room for max_samples * sample_size values
+		 * @param max_samples	The most samples to remove
+		 * @return 				The number of samples removed
+		 */
+		size_t drain(double* output, size_t max_samples);
+
+		/**
+		 * Gets the number of samples waiting to be drained
+		 * @return		The backlog, which may already be out of date if the other thread is running
+		 */
+		size_t getBacklog() const;
+
+		/**
+		 * Gets the largest backlog seen by drain()
+		 * @return		The highest number of samples drained at once
+		 */
+		size_t getMaxBacklog() const {return max_backlog_.load(std::memory_order_relaxed);};
+
+		/**
+		 * Gets the number of samples dropped because the ring was full
+		 * @return		The number of overruns
+		 */
+		size_t getOverruns() const {return overruns_.load(std::memory_order_relaxed);};
+
+		/**
+		 * Gets the maximum number of samples waiting to be drained
+		 * @return		The capacity
+		 */
+		size_t getCapacity() const {return capacity_;};
+
+		/**
+		 * Gets the number of values in each sample
+		 * @return		The sample size
+		 */
+		size_t getSampleSize() const {return sample_size_;};
+
+	private:
+		size_t sample_size_;
+		size_t capacity_;
+		std::vector<double> samples_;
+
+		// Write and read positions, counting up forever. Padded so the two threads do not share a cache line
+		char pad0_[64];
+		std::atomic<size_t> head_;
+		char pad1_[64];
+		std::atomic<size_t> tail_;
+		char pad2_[64];
+		std::atomic<size_t> overruns_;
+		std::atomic<size_t> max_backlog_;
+	};
+
+	inline SpscSampleRing::SpscSampleRing(size_t sample_size, size_t capacity)
+	 : sample_size_(sample_size), head_(0), tail_(0), overruns_(0), max_backlog_(0)
+	{
+		if(capacity == 0)
+		{
+			throw std::invalid_argument("Capacity must be positive");
+		}
+		capacity_ = 1;
+		while(capacity_ < capacity) capacity_ *= 2;
+		samples_.resize(capacity_ * sample_size_);
+	}
+
+	inline double* SpscSampleRing::claim()
+	{
+		const size_t head = head_.load(std::memory_order_relaxed);
+		if(head - tail_.load(std::memory_order_acquire) >= capacity_)
+		{
+			overruns_.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		return &samples_[(head & (capacity_ - 1)) * sample_size_];
+	}
+
+	inline bool SpscSampleRing::push(const double* sample)
+	{
+		double* slot = claim();
+		if(!slot) return false;
+		for(size_t i=0; i<sample_size_; ++i)
+		{
+			slot[i] = sample[i];
+		}
+		commit();
+		return true;
+	}
+
+	inline bool SpscSampleRing::push(const std::vector<double>& sample)
+	{
+		if(sample.size() != sample_size_)
+		{
+			throw std::invalid_argument("Sample size does not match the ring");
+		}
+		return push(sample.data());
+	}
+
+	inline size_t SpscSampleRing::drain(double* output, size_t max_samples)
+	{
+		const size_t tail = tail_.load(std::memory_order_relaxed);
+		const size_t backlog = head_.load(std::memory_order_acquire) - tail;
+		const size_t count = std::min(backlog, max_samples);
+		for(size_t n=0; n<count; ++n)
+		{
+			const double* slot = &samples_[((tail + n) & (capacity_ - 1)) * sample_size_];
+			for(size_t i=0; i<sample_size_; ++i)
+			{
+				output[n*sample_size_ + i] = slot[i];
+			}
+		}
+		tail_.store(tail + count, std::memory_order_release);
+
+		if(backlog > max_backlog_.load(std::memory_order_relaxed))
+		{
+			max_backlog_.store(backlog, std::memory_order_relaxed);
+		}
+		return count;
+	}
+
+	inline size_t SpscSampleRing::getBacklog() const
+	{
+		return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+	}
+
+} // end nrg_tools namespace
@@ -0,0 +1,249 @@
+#pragma once
+
+/**
+ * A fixed size history of stamped messages, for looking up interpolated values at any time
+ * (e.g. the pose of the sensor at the stamp of a wrench)
+ */
+
+#include "conversions.hpp"
+#include <stdexcept>
+
+namespace nrg_tools{
+
+	/**
+	 * Gets the index of the quaternion in the converted form of a message, so it can be slerped
+	 * @return		The index of the x component, or -1 if the message has no rotation
+	 */
+	template <class T> int quaternionIndex(const T&) {return -1;}
+	inline int quaternionIndex(const geometry_msgs::PoseStamped&) {return 3;}
+	inline int quaternionIndex(const geometry_msgs::TransformStamped&) {return 3;}
+	inline int quaternionIndex(const geometry_msgs::QuaternionStamped&) {return 0;}
+
+	/**
+	 * \class StampedCache
+	 * Keeps the newest messages of a stamped type with valid conversion functions, in a ring of flattened vectors,
+	 * and looks up the value at any time between them. Values are interpolated linearly between the two nearest
+	 * messages, except rotations, which are slerped. Lookups start from the messages used by the previous lookup,
+	 * so queries that move forward in time (or only slightly back) cost O(1). Messages are converted straight into
+	 * the ring, so for fixed size types (e.g. geometry_msgs) neither inserts nor lookups allocate once the ring is full
+	 */
+	template <class T>
+	class StampedCache
+	{
+	public:
+		/**
+		 * Constructor
+		 * @param capacity		The number of messages kept. Once full, inserting drops the oldest message
+		 */
+		explicit StampedCache(size_t capacity);
+
+		/**
+		 * Adds a message to the cache
+		 * @param message	The message. Must be newer than every message already in the cache,
+		 *					and convert to the same number of values
+		 * @return 			Returns 'false' if the message was rejected, 'true' otherwise
+		 */
+		bool insert(const T& message);
+
+		/**
+		 * Gets the interpolated value at a time
+		 * @param stamp		The time to look up
+		 * @param output	The value at that time. Fields that are not converted (e.g. header.frame_id) are copied from
+		 *					the cached message at or before the time, and the stamp is set to the time
+		 * @return 			Returns 'false' if the time is outside of the cached messages, 'true' otherwise
+		 */
+		bool lookup(const ros::Time& stamp, T& output);
+
+		/**
+		 * Gets the interpolated value at a time, in its converted form
+		 * @param stamp		The time to look up
+		 * @param output	The value at that time. Resized if needed
+		 * @return 			Returns 'false' if the time is outside of the cached messages, 'true' otherwise
+		 */
+		bool lookup(const ros::Time& stamp, std::vector<double>& output);
+
+		/**
+		 * Removes all messages
+		 */
+		void clear() {count_ = 0; cursor_ = 0;};
+
+		/**
+		 * Gets the number of messages in the cache
+		 * @return		The number of messages, at most the capacity
+		 */
+		size_t size() const {return count_;};
+
+		/**
+		 * Gets the most messages the cache keeps
+		 * @return		The capacity
+		 */
+		size_t getCapacity() const {return capacity_;};
+
+		/**
+		 * Gets the stamp of the oldest message. Only valid if size() > 0
+		 * @return		The oldest stamp
+		 */
+		ros::Time getOldestStamp() const {return ros::Time(stampAt(0));};
+
+		/**
+		 * Gets the stamp of the newest message. Only valid if size() > 0
+		 * @return		The newest stamp
+		 */
+		ros::Time getNewestStamp() const {return ros::Time(stampAt(count_ - 1));};
+
+	private:
+		size_t capacity_;
+		size_t size_ = 0;					// The number of values in each message
+		size_t count_ = 0;
+		size_t oldest_ = 0;					// The slot of the oldest message
+		size_t cursor_ = 0;					// The position (0 = oldest) of the message before the last lookup
+		int quaternion_index_ = -1;
+		std::vector<double> stamps_;
+		std::vector<double> data_;			// Flattened messages, data_[slot*size_ + value]
+		std::vector<T> messages_;			// The messages, for the fields that are not converted
+		std::vector<double> scratch_;
+
+		double stampAt(size_t position) const {return stamps_[(oldest_ + position) % capacity_];};
+		const double* dataAt(size_t position) const {return &data_[((oldest_ + position) % capacity_) * size_];};
+
+		/**
+		 * Finds the position of the newest message at or before a time inside the cache
+		 */
+		size_t findPosition(const double stamp);
+	};
+
+	template <class T>
+	StampedCache<T>::StampedCache(size_t capacity) : capacity_(capacity), stamps_(capacity)
+	{
+		if(capacity_ < 2)
+		{
+			throw std::invalid_argument("Capacity must be at least 2 to interpolate");
+		}
+	}
+
+	template <class T>
+	bool StampedCache<T>::insert(const T& message)
+	{
+		const double stamp = message.header.stamp.toSec();
+		if(count_ > 0 && stamp <= stampAt(count_ - 1))
+		{
+			return false;
+		}
+
+		if(messages_.empty())
+		{
+			// The first message sets the size of everything
+			const std::vector<double> first = nrg_conversions::toVec(message);
+			size_ = first.size();
+			quaternion_index_ = quaternionIndex(message);
+			data_.resize(capacity_ * size_);
+			scratch_.resize(size_);
+			messages_.resize(capacity_);
+		}
+
+		// Converting checks the size before writing, so a rejected message leaves the slot (the oldest, if full) as it was
+		const size_t slot = (oldest_ + count_) % capacity_;
+		if(!convert(message, Eigen::Map<Eigen::VectorXd>(&data_[slot * size_], size_)))
+		{
+			return false;
+		}
+
+		if(count_ == capacity_)
+		{
+			// Overwrite the oldest message
+			oldest_ = (oldest_ + 1) % capacity_;
+			--count_;
+			if(cursor_ > 0) --cursor_;
+		}
+		stamps_[slot] = stamp;
+		messages_[slot] = message;
+		++count_;
+		return true;
+	}
+
+	template <class T>
+	size_t StampedCache<T>::findPosition(const double stamp)
+	{
+		// Walk a few messages from the last lookup first
+		size_t position = std::min(cursor_, count_ - 1);
+		for(int step=0; step<4; ++step)
+		{
+			if(stampAt(position) > stamp)
+			{
+				--position;
+			}
+			else if(position + 1 < count_ && stampAt(position + 1) <= stamp)
+			{
+				++position;
+			}
+			else
+			{
+				return position;
+			}
+		}
+
+		// Otherwise binary search for the last stamp <= the time
+		size_t low = 0, high = count_ - 1;
+		while(low < high)
+		{
+			const size_t middle = (low + high + 1) / 2;
+			if(stampAt(middle) <= stamp) low = middle;
+			else high = middle - 1;
+		}
+		return low;
+	}
+
+	template <class T>
+	bool StampedCache<T>::lookup(const ros::Time& stamp, std::vector<double>& output)
+	{
+		NRG_PROFILE_SCOPE("StampedCache::lookup");
+		const double time = stamp.toSec();
+		if(count_ == 0 || time < stampAt(0) || time > stampAt(count_ - 1))
+		{
+			return false;
+		}
+
+		cursor_ = findPosition(time);
+		output.resize(size_);
+		const double* before = dataAt(cursor_);
+		if(cursor_ + 1 == count_)
+		{
+			std::copy(before, before + size_, output.begin());
+			return true;
+		}
+
+		const double* after = dataAt(cursor_ + 1);
+		const double fraction = (time - stampAt(cursor_)) / (stampAt(cursor_ + 1) - stampAt(cursor_));
+		for(size_t i=0; i<size_; ++i)
+		{
+			output[i] = before[i] + fraction * (after[i] - before[i]);
+		}
+
+		if(quaternion_index_ >= 0)
+		{
+			const double* q0 = before + quaternion_index_;
+			const double* q1 = after + quaternion_index_;
+			const Eigen::Quaterniond start(q0[3], q0[0], q0[1], q0[2]), end(q1[3], q1[0], q1[1], q1[2]);
+			if(start.squaredNorm() > 0 && end.squaredNorm() > 0)
+			{
+				// slerp takes the short way around
+				Eigen::Map<Eigen::Vector4d> rotation(&output[quaternion_index_]);
+				rotation = start.normalized().slerp(fraction, end.normalized()).coeffs();
+			}
+		}
+		return true;
+	}
+
+	template <class T>
+	bool StampedCache<T>::lookup(const ros::Time& stamp, T& output)
+	{
+		if(!lookup(stamp, scratch_))
+		{
+			return false;
+		}
+		output = messages_[(oldest_ + cursor_) % capacity_];
+		output.header.stamp = stamp;
+		return nrg_conversions::fromVec(scratch_, output);
+	}
+
+} // end nrg_tools namespace
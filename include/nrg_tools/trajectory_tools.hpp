@@ -0,0 +1,175 @@
+#pragma once
+
+/**
+ * Bulk conversion of whole trajectory_msgs::JointTrajectory's to and from Eigen matrices,
+ * so long trajectories can be bounded, filtered or interpolated a matrix at a time
+ */
+
+#include "conversions.hpp"
+#include "joint_order_plan.hpp"
+
+namespace nrg_tools{
+
+	/**
+	 * \struct JointTrajectoryMatrices
+	 * The data of a trajectory_msgs::JointTrajectory, with one column per point and one row per joint
+	 * (the same layout as the waypoints of a TrajectoryInterpolator). Fields the trajectory does not have are 0 x 0
+	 */
+	struct JointTrajectoryMatrices
+	{
+		Eigen::VectorXd times;				// The time_from_start of each point, in seconds
+		Eigen::MatrixXd positions;
+		Eigen::MatrixXd velocities;
+		Eigen::MatrixXd accelerations;
+		Eigen::MatrixXd effort;
+	};
+
+	namespace trajectory_fields{
+		typedef std::vector<double> trajectory_msgs::JointTrajectoryPoint::* Field;
+		const Field fields[4] = {&trajectory_msgs::JointTrajectoryPoint::positions, &trajectory_msgs::JointTrajectoryPoint::velocities,
+								 &trajectory_msgs::JointTrajectoryPoint::accelerations, &trajectory_msgs::JointTrajectoryPoint::effort};
+
+		inline Eigen::MatrixXd* matrices(JointTrajectoryMatrices& data, const size_t field)
+		{
+			Eigen::MatrixXd* all[4] = {&data.positions, &data.velocities, &data.accelerations, &data.effort};
+			return all[field];
+		}
+
+		inline const Eigen::MatrixXd* matrices(const JointTrajectoryMatrices& data, const size_t field)
+		{
+			const Eigen::MatrixXd* all[4] = {&data.positions, &data.velocities, &data.accelerations, &data.effort};
+			return all[field];
+		}
+
+		/**
+		 * Fills the matrices from the points in one pass, reordering the joints if a plan is given
+		 */
+		inline bool toMatrices(const trajectory_msgs::JointTrajectory& input, JointTrajectoryMatrices& output, const JointOrderPlan* plan)
+		{
+			const size_t num_points = input.points.size();
+			size_t num_joints = input.joint_names.size();
+			if(plan) num_joints = plan->getNumberJoints();
+			else if(num_joints == 0 && num_points > 0) num_joints = input.points[0].positions.size();
+
+			// A field is used if the first point has it, and then every point must have it.
+			// Eigen only reallocates if a size changes, so converting trajectories of the same size reuses the memory
+			bool used[4];
+			output.times.resize(num_points);
+			for(size_t i=0; i<4; ++i)
+			{
+				used[i] = num_points > 0 && !(input.points[0].*fields[i]).empty();
+				matrices(output, i)->resize(used[i] ? num_joints : 0, used[i] ? num_points : 0);
+			}
+
+			for(size_t point=0; point<num_points; ++point)
+			{
+				output.times[point] = input.points[point].time_from_start.toSec();
+				for(size_t i=0; i<4; ++i)
+				{
+					const std::vector<double>& field = input.points[point].*fields[i];
+					if(!used[i])
+					{
+						if(!field.empty()) return false;
+					}
+					else if(plan)
+					{
+						if(!plan->gather(field, matrices(output, i)->col(point))) return false;
+					}
+					else
+					{
+						if(field.size() != num_joints) return false;
+						matrices(output, i)->col(point) = Eigen::Map<const Eigen::VectorXd>(field.data(), num_joints);
+					}
+				}
+			}
+			return true;
+		}
+	} // end trajectory_fields namespace
+
+	/**
+	 * Converts a whole trajectory_msgs::JointTrajectory into matrices, in one pass over the points.
+	 * Matrices that are already the right size are reused, so converting many trajectories of
+	 * the same size does not allocate
+	 * @param input		The trajectory. Points must all have the same fields, with one value per joint
+	 * @param output	The matrices, in the joint order of the trajectory
+	 * @return 			Returns 'true' if the conversion was successful, 'false' otherwise
+	 */
+	inline bool convert(const trajectory_msgs::JointTrajectory& input, JointTrajectoryMatrices& output)
+	{
+		NRG_PROFILE_SCOPE("convert JointTrajectory");
+		return trajectory_fields::toMatrices(input, output, nullptr);
+	}
+
+	/**
+	 * Converts a whole trajectory_msgs::JointTrajectory into matrices, in the joint order of a plan
+	 * @param input		The trajectory. Points must all have the same fields, with one value per joint
+	 * @param output	The matrices, with one row per joint of the plan
+	 * @param plan		The joint order plan, updated from the trajectory's joint_names if needed
+	 * @return 			Returns 'true' if the conversion was successful, 'false' otherwise
+	 */
+	inline bool convert(const trajectory_msgs::JointTrajectory& input, JointTrajectoryMatrices& output, JointOrderPlan& plan)
+	{
+		NRG_PROFILE_SCOPE("convert JointTrajectory");
+		if(!plan.update(input.joint_names)) return false;
+		return trajectory_fields::toMatrices(input, output, &plan);
+	}
+
+	/**
+	 * Converts matrices back into a trajectory_msgs::JointTrajectory. The points are resized once, and
+	 * each point's fields reuse their memory when the sizes do not change. The header and joint_names are kept
+	 * @param input		The matrices. Every matrix that is not empty must have a column per time and the same number of rows
+	 * @param output	The trajectory. Its joint_names must be empty or match the number of rows
+	 * @return 			Returns 'true' if the conversion was successful, 'false' otherwise
+	 */
+	inline bool convert(const JointTrajectoryMatrices& input, trajectory_msgs::JointTrajectory& output)
+	{
+		NRG_PROFILE_SCOPE("convert JointTrajectory");
+		const Eigen::Index num_points = input.times.size();
+		Eigen::Index num_joints = -1;
+		for(size_t i=0; i<4; ++i)
+		{
+			const Eigen::MatrixXd& matrix = *trajectory_fields::matrices(input, i);
+			if(matrix.size() == 0) continue;
+			if(matrix.cols() != num_points || (num_joints >= 0 && matrix.rows() != num_joints)) return false;
+			num_joints = matrix.rows();
+		}
+		if(num_joints >= 0 && !output.joint_names.empty() && output.joint_names.size() != static_cast<size_t>(num_joints)) return false;
+
+		output.points.resize(num_points);
+		for(Eigen::Index point=0; point<num_points; ++point)
+		{
+			output.points[point].time_from_start = ros::Duration(input.times[point]);
+			for(size_t i=0; i<4; ++i)
+			{
+				const Eigen::MatrixXd& matrix = *trajectory_fields::matrices(input, i);
+				std::vector<double>& field = output.points[point].*trajectory_fields::fields[i];
+				if(matrix.size() == 0) field.clear();
+				else field.assign(matrix.col(point).data(), matrix.col(point).data() + num_joints);
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Converts matrices in the joint order of a plan back into a trajectory_msgs::JointTrajectory.
+	 * The joint_names are set to the plan's joint order, so the values stay with their joints
+	 * @param input		The matrices, with one row per joint of the plan
+	 * @param output	The trajectory. The header is kept
+	 * @param plan		The joint order plan the matrices were converted with
+	 * @return 			Returns 'true' if the conversion was successful, 'false' otherwise
+	 */
+	inline bool convert(const JointTrajectoryMatrices& input, trajectory_msgs::JointTrajectory& output, const JointOrderPlan& plan)
+	{
+		for(size_t i=0; i<4; ++i)
+		{
+			const Eigen::MatrixXd& matrix = *trajectory_fields::matrices(input, i);
+			if(matrix.size() != 0 && static_cast<size_t>(matrix.rows()) != plan.getNumberJoints()) return false;
+		}
+		if(output.joint_names != plan.getJointNames())
+		{
+			output.joint_names = plan.getJointNames();
+		}
+		return convert(input, output);
+	}
+
+} // end nrg_tools namespace
@@ -0,0 +1,630 @@
+#pragma once
+
+/**
+ * Applying geometry_msgs::Transform / geometry_msgs::Pose to batches of points, wrenches and twists.
+ * The quaternion is converted to a rotation matrix (or 6x6 adjoint) once, and the cached
+ * matrix is then applied to whole sets at a time
+ */
+
+#include "conversions.hpp"
+#include <exception>
+#include <string>
+
+namespace nrg_tools{
+
+	/**
+	 * Converts a geometry_msgs::Transform into an Eigen::Isometry3d. The rotation is normalized
+	 * @param input		The transform message
+	 * @param output	The equivalent isometry
+	 * @return 			Returns 'false' if the rotation is a zero quaternion, 'true' otherwise
+	 */
+	inline bool convert(const geometry_msgs::Transform& input, Eigen::Isometry3d& output)
+	{
+		Eigen::Quaterniond quat(input.rotation.w, input.rotation.x, input.rotation.y, input.rotation.z);
+		if(quat.squaredNorm() == 0) return false;
+		output.linear() = quat.normalized().toRotationMatrix();
+		output.translation() << input.translation.x, input.translation.y, input.translation.z;
+		output.makeAffine();
+		return true;
+	}
+
+	/**
+	 * Converts a geometry_msgs::Pose into an Eigen::Isometry3d. The orientation is normalized
+	 * @param input		The pose message
+	 * @param output	The equivalent isometry
+	 * @return 			Returns 'false' if the orientation is a zero quaternion, 'true' otherwise
+	 */
+	inline bool convert(const geometry_msgs::Pose& input, Eigen::Isometry3d& output)
+	{
+		geometry_msgs::Transform tran;
+		tran.translation.x = input.position.x; tran.translation.y = input.position.y; tran.translation.z = input.position.z;
+		tran.rotation = input.orientation;
+		return convert(tran, output);
+	}
+
+	/**
+	 * Converts the transform of a geometry_msgs::TransformStamped into an Eigen::Isometry3d
+	 * @param input		The stamped transform message
+	 * @param output	The equivalent isometry
+	 * @return 			Returns 'false' if the rotation is a zero quaternion, 'true' otherwise
+	 */
+	inline bool convert(const geometry_msgs::TransformStamped& input, Eigen::Isometry3d& output)
+	{
+		return convert(input.transform, output);
+	}
+
+	/**
+	 * Converts the pose of a geometry_msgs::PoseStamped into an Eigen::Isometry3d
+	 * @param input		The stamped pose message
+	 * @param output	The equivalent isometry
+	 * @return 			Returns 'false' if the orientation is a zero quaternion, 'true' otherwise
+	 */
+	inline bool convert(const geometry_msgs::PoseStamped& input, Eigen::Isometry3d& output)
+	{
+		return convert(input.pose, output);
+	}
+
+	/**
+	 * Converts an Eigen::Isometry3d into a geometry_msgs::Transform
+	 * @param input		The isometry
+	 * @param output	The equivalent transform message
+	 * @return 			Always 'true'
+	 */
+	inline bool convert(const Eigen::Isometry3d& input, geometry_msgs::Transform& output)
+	{
+		const Eigen::Quaterniond quat(input.linear());
+		output.translation.x = input.translation().x();
+		output.translation.y = input.translation().y();
+		output.translation.z = input.translation().z();
+		output.rotation.x = quat.x(); output.rotation.y = quat.y(); output.rotation.z = quat.z(); output.rotation.w = quat.w();
+		return true;
+	}
+
+	/**
+	 * Converts an Eigen::Isometry3d into a geometry_msgs::Pose
+	 * @param input		The isometry
+	 * @param output	The equivalent pose message
+	 * @return 			Always 'true'
+	 */
+	inline bool convert(const Eigen::Isometry3d& input, geometry_msgs::Pose& output)
+	{
+		geometry_msgs::Transform tran;
+		convert(input, tran);
+		output.position.x = tran.translation.x; output.position.y = tran.translation.y; output.position.z = tran.translation.z;
+		output.orientation = tran.rotation;
+		return true;
+	}
+
+	/**
+	 * \class RigidTransform
+	 * A rigid transform compiled from a ROS message into a cached Eigen::Isometry3d.
+	 * Meant to be built (or updated) once per transform and then applied to many points
+	 */
+	class RigidTransform
+	{
+	public:
+		/**
+		 * Constructor for the identity transform
+		 */
+		RigidTransform() : isometry_(Eigen::Isometry3d::Identity()) {};
+
+		/**
+		 * Constructor
+		 * @param isometry		The transform to apply. Must be a proper rigid transform
+		 */
+		explicit RigidTransform(const Eigen::Isometry3d& isometry) : isometry_(isometry) {};
+
+		/**
+		 * Constructor. Throws an error if the rotation is a zero quaternion
+		 * @param input		A geometry_msgs::Transform, TransformStamped, Pose or PoseStamped
+		 */
+		template <class T> explicit RigidTransform(const T& input) {update(input);};
+
+		/**
+		 * Recompiles the transform from a message, but only if the message differs from the last one used
+		 * @param input		A geometry_msgs::Transform
+		 * @return 			'true' if the cached transform was recomputed
+		 */
+		bool update(const geometry_msgs::Transform& input);
+
+		/**
+		 * Recompiles the transform from a message, but only if the message differs from the last one used
+		 * @param input		A geometry_msgs::Pose
+		 * @return 			'true' if the cached transform was recomputed
+		 */
+		bool update(const geometry_msgs::Pose& input);
+
+		/**
+		 * Recompiles the transform from a stamped message. The header is ignored
+		 * @param input		A geometry_msgs::TransformStamped
+		 * @return 			'true' if the cached transform was recomputed
+		 */
+		bool update(const geometry_msgs::TransformStamped& input) {return update(input.transform);};
+
+		/**
+		 * Recompiles the transform from a stamped message. The header is ignored
+		 * @param input		A geometry_msgs::PoseStamped
+		 * @return 			'true' if the cached transform was recomputed
+		 */
+		bool update(const geometry_msgs::PoseStamped& input) {return update(input.pose);};
+
+		/**
+		 * Transforms a set of points stored one per column
+		 * @param input		The points to transform
+		 * @param output	The transformed points. May be the same matrix as the input
+		 */
+		void apply(const Eigen::Matrix3Xd& input, Eigen::Matrix3Xd& output) const;
+
+		/**
+		 * Transforms every point of a polygon. The math is done in double precision
+		 * @param input		The polygon to transform
+		 * @param output	The transformed polygon. May be the same polygon as the input
+		 */
+		void apply(const geometry_msgs::Polygon& input, geometry_msgs::Polygon& output) const;
+
+		/**
+		 * Transforms a single point
+		 * @param point		The point to transform
+		 * @return 			The transformed point
+		 */
+		Eigen::Vector3d apply(const Eigen::Vector3d& point) const {return isometry_.linear() * point + isometry_.translation();};
+
+		/**
+		 * Gets the inverse transform, using the transpose of the rotation rather than a general inverse
+		 * @return 			The inverse of this transform
+		 */
+		RigidTransform inverse() const {return RigidTransform(Eigen::Isometry3d(isometry_.inverse(Eigen::Isometry)));};
+
+		/**
+		 * Composes two transforms, such that (a * b).apply(p) == a.apply(b.apply(p))
+		 * @param other		The transform to apply first
+		 * @return 			The composed transform
+		 */
+		RigidTransform operator*(const RigidTransform& other) const {return RigidTransform(Eigen::Isometry3d(isometry_ * other.isometry_));};
+
+		/**
+		 * Composes a chain of transforms, such that the last one in the chain is applied first
+		 * (e.g. {world_T_base, base_T_tool} gives world_T_tool)
+		 * @param chain		The transforms to compose
+		 * @return 			The composed transform, or identity for an empty chain
+		 */
+		static RigidTransform compose(const std::vector<RigidTransform>& chain);
+
+		/**
+		 * Gets the cached transform
+		 * @return 			The transform as an Eigen::Isometry3d
+		 */
+		Eigen::Isometry3d getIsometry() const {return Eigen::Isometry3d(isometry_);};
+
+	private:
+		// Unaligned storage so RigidTransform can be kept in std containers without an aligned allocator
+		Eigen::Transform<double, 3, Eigen::Isometry, Eigen::DontAlign> isometry_;
+		geometry_msgs::Transform last_input_;
+		bool has_input_ = false;
+	};
+
+	inline bool RigidTransform::update(const geometry_msgs::Transform& input)
+	{
+		if(has_input_ && input.translation.x == last_input_.translation.x && input.translation.y == last_input_.translation.y
+			&& input.translation.z == last_input_.translation.z && input.rotation.x == last_input_.rotation.x
+			&& input.rotation.y == last_input_.rotation.y && input.rotation.z == last_input_.rotation.z
+			&& input.rotation.w == last_input_.rotation.w)
+		{
+			return false;
+		}
+
+		Eigen::Isometry3d isometry;
+		if(!convert(input, isometry))
+		{
+			throw std::invalid_argument("Transform rotation is a zero quaternion");
+		}
+		isometry_ = isometry;
+		last_input_ = input;
+		has_input_ = true;
+		return true;
+	}
+
+	inline bool RigidTransform::update(const geometry_msgs::Pose& input)
+	{
+		geometry_msgs::Transform tran;
+		tran.translation.x = input.position.x; tran.translation.y = input.position.y; tran.translation.z = input.position.z;
+		tran.rotation = input.orientation;
+		return update(tran);
+	}
+
+	inline void RigidTransform::apply(const Eigen::Matrix3Xd& input, Eigen::Matrix3Xd& output) const
+	{
+		// Rotate the whole block at once so Eigen can vectorize it
+		if(&input == &output)
+		{
+			output = isometry_.linear() * input;
+		}
+		else
+		{
+			output.noalias() = isometry_.linear() * input;
+		}
+		output.colwise() += isometry_.translation();
+	}
+
+	inline void RigidTransform::apply(const geometry_msgs::Polygon& input, geometry_msgs::Polygon& output) const
+	{
+		static_assert(sizeof(geometry_msgs::Point32) == 3*sizeof(float), "Point32 is expected to be 3 packed floats");
+		typedef Eigen::Map<Eigen::Matrix3Xf> PointsMap;
+		typedef Eigen::Map<const Eigen::Matrix3Xf> ConstPointsMap;
+
+		output.points.resize(input.points.size());
+		if(input.points.empty()) return;
+
+		ConstPointsMap input_map(&input.points[0].x, 3, input.points.size());
+		PointsMap output_map(&output.points[0].x, 3, output.points.size());
+		const Eigen::Matrix3Xd transformed = (isometry_.linear() * input_map.cast<double>()).colwise() + isometry_.translation();
+		output_map = transformed.cast<float>();
+	}
+
+	inline RigidTransform RigidTransform::compose(const std::vector<RigidTransform>& chain)
+	{
+		Eigen::Isometry3d output = Eigen::Isometry3d::Identity();
+		for(size_t i=0; i<chain.size(); ++i)
+		{
+			output = output * chain[i].isometry_;
+		}
+		return RigidTransform(output);
+	}
+
+	typedef Eigen::Matrix<double, 6, 1> Vector6d;
+	typedef Eigen::Matrix<double, 6, Eigen::Dynamic> Matrix6Xd;
+
+	/**
+	 * \class AdjointTransform
+	 * The 6x6 adjoint of a rigid transform, for moving twists and wrenches between frames.
+	 * Twists are [linear; angular] and wrenches are [force; torque], the same order convert() uses.
+	 * For the transform of frame B in frame A (A_T_B), twists are moved from B to A with the adjoint,
+	 * and wrenches with the transpose of the inverse adjoint, so the torque is taken about the origin of A.
+	 * Both matrices are only recomputed when the transform message changes
+	 */
+	class AdjointTransform
+	{
+	public:
+		/**
+		 * Constructor for the identity transform
+		 */
+		AdjointTransform() : adjoint_(Eigen::Matrix<double, 6, 6>::Identity()), inverse_adjoint_(Eigen::Matrix<double, 6, 6>::Identity()) {};
+
+		/**
+		 * Constructor. Throws an error if the rotation is a zero quaternion
+		 * @param input		A geometry_msgs::Transform, TransformStamped, Pose or PoseStamped
+		 */
+		template <class T> explicit AdjointTransform(const T& input) {update(input);};
+
+		/**
+		 * Recomputes the adjoints from a message, but only if the message differs from the last one used
+		 * @param input		A geometry_msgs::Transform, TransformStamped, Pose or PoseStamped. Headers are ignored
+		 * @return 			'true' if the cached adjoints were recomputed
+		 */
+		template <class T> bool update(const T& input);
+
+		/**
+		 * Moves a twist from the child frame into the parent frame
+		 * @param input		The twist, [linear; angular], in the child frame
+		 * @param inverse	If 'true', moves the twist from the parent frame into the child frame instead
+		 * @return 			The twist in the other frame
+		 */
+		Vector6d transformTwist(const Vector6d& input, bool inverse=false) const
+		{
+			return inverse ? Vector6d(inverse_adjoint_ * input) : Vector6d(adjoint_ * input);
+		};
+
+		/**
+		 * Moves a wrench from the child frame into the parent frame
+		 * @param input		The wrench, [force; torque], in the child frame
+		 * @param inverse	If 'true', moves the wrench from the parent frame into the child frame instead
+		 * @return 			The wrench in the other frame
+		 */
+		Vector6d transformWrench(const Vector6d& input, bool inverse=false) const
+		{
+			return inverse ? Vector6d(adjoint_.transpose() * input) : Vector6d(inverse_adjoint_.transpose() * input);
+		};
+
+		/**
+		 * Moves a set of twists, stored one per column, in one matrix product
+		 * @param input		The twists to move
+		 * @param output	The moved twists. May be the same matrix as the input
+		 * @param inverse	If 'true', moves the twists from the parent frame into the child frame instead
+		 */
+		void transformTwists(const Matrix6Xd& input, Matrix6Xd& output, bool inverse=false) const;
+
+		/**
+		 * Moves a set of wrenches, stored one per column, in one matrix product
+		 * @param input		The wrenches to move
+		 * @param output	The moved wrenches. May be the same matrix as the input
+		 * @param inverse	If 'true', moves the wrenches from the parent frame into the child frame instead
+		 */
+		void transformWrenches(const Matrix6Xd& input, Matrix6Xd& output, bool inverse=false) const;
+
+		/**
+		 * Gets the cached twist adjoint
+		 * @return 			The 6x6 adjoint of the transform
+		 */
+		Eigen::Matrix<double, 6, 6> getAdjoint() const {return adjoint_;};
+
+		/**
+		 * Gets the cached transform
+		 * @return 			The transform as a RigidTransform
+		 */
+		const RigidTransform& getTransform() const {return transform_;};
+
+	private:
+		RigidTransform transform_;
+		// Unaligned storage so AdjointTransform can be kept in std containers without an aligned allocator
+		Eigen::Matrix<double, 6, 6, Eigen::DontAlign> adjoint_, inverse_adjoint_;
+	};
+
+	template <class T>
+	bool AdjointTransform::update(const T& input)
+	{
+		if(!transform_.update(input))
+		{
+			return false;
+		}
+
+		// Ad = [R, [p]R; 0, R] and Ad^-1 = [R', -R'[p]; 0, R']
+		const Eigen::Isometry3d isometry = transform_.getIsometry();
+		const Eigen::Matrix3d rotation = isometry.linear();
+		const Eigen::Vector3d p = isometry.translation();
+		Eigen::Matrix3d skew;
+		skew << 0, -p.z(), p.y(),
+				p.z(), 0, -p.x(),
+				-p.y(), p.x(), 0;
+		adjoint_ << rotation, skew * rotation, Eigen::Matrix3d::Zero(), rotation;
+		inverse_adjoint_ << rotation.transpose(), -rotation.transpose() * skew, Eigen::Matrix3d::Zero(), rotation.transpose();
+		return true;
+	}
+
+	inline void AdjointTransform::transformTwists(const Matrix6Xd& input, Matrix6Xd& output, bool inverse) const
+	{
+		const Eigen::Matrix<double, 6, 6> adjoint = inverse ? inverse_adjoint_ : adjoint_;
+		if(&input == &output)
+		{
+			output = adjoint * input;
+		}
+		else
+		{
+			output.noalias() = adjoint * input;
+		}
+	}
+
+	inline void AdjointTransform::transformWrenches(const Matrix6Xd& input, Matrix6Xd& output, bool inverse) const
+	{
+		const Eigen::Matrix<double, 6, 6> adjoint = inverse ? adjoint_.transpose() : inverse_adjoint_.transpose();
+		if(&input == &output)
+		{
+			output = adjoint * input;
+		}
+		else
+		{
+			output.noalias() = adjoint * input;
+		}
+	}
+
+	/**
+	 * \class FrameTransformer
+	 * Moves stamped wrenches and twists between frames, with an AdjointTransform cached per pair of frames.
+	 * Transforms are given directly or looked up from a tf buffer, and the adjoints are only recomputed when a
+	 * transform changes. Each pair also works in reverse, so one transform between the sensor and tool frames
+	 * moves wrenches both ways, and data already in the target frame is passed through unchanged. Frame pairs
+	 * are searched linearly, so this is meant for a handful of frames
+	 */
+	class FrameTransformer
+	{
+	public:
+		/**
+		 * Sets the transform between two frames
+		 * @param transform		The transform of the child_frame_id in the header's frame_id, as given by tf
+		 * @return 				'true' if the cached adjoints were recomputed
+		 */
+		bool setTransform(const geometry_msgs::TransformStamped& transform);
+
+		/**
+		 * Looks up the transform between two frames from a tf buffer (e.g. a tf2_ros::Buffer, or a tf2::BufferCore
+		 * filled by hand for testing), and caches it. This calls into the buffer, so keep it out of the control loop
+		 * when the transform is static
+		 * @param buffer			Anything with lookupTransform(target_frame, source_frame, time) returning a TransformStamped
+		 * @param target_frame		The frame to move data into
+		 * @param source_frame		The frame the data is in
+		 * @param time				The time to look up, or ros::Time(0) for the latest
+		 * @return 					'false' if the buffer could not give the transform, 'true' otherwise
+		 */
+		template <class Buffer> bool lookupTransform(const Buffer& buffer, const std::string& target_frame,
+													 const std::string& source_frame, const ros::Time& time=ros::Time(0));
+
+		/**
+		 * Moves a wrench into another frame. The header frame_id of the output is set to the target frame
+		 * @param input				The wrench, in the frame of its header
+		 * @param target_frame		The frame to move the wrench into
+		 * @param output			The moved wrench. May be the same message as the input
+		 * @return 					'false' if no transform between the frames is cached, 'true' otherwise
+		 */
+		bool transform(const geometry_msgs::WrenchStamped& input, const std::string& target_frame, geometry_msgs::WrenchStamped& output) const;
+
+		/**
+		 * Moves a twist into another frame. The header frame_id of the output is set to the target frame
+		 * @param input				The twist, in the frame of its header
+		 * @param target_frame		The frame to move the twist into
+		 * @param output			The moved twist. May be the same message as the input
+		 * @return 					'false' if no transform between the frames is cached, 'true' otherwise
+		 */
+		bool transform(const geometry_msgs::TwistStamped& input, const std::string& target_frame, geometry_msgs::TwistStamped& output) const;
+
+		/**
+		 * Moves a set of wrenches, stored one per column, from one frame into another
+		 * @param input				The wrenches, in the source frame
+		 * @param target_frame		The frame to move the wrenches into
+		 * @param source_frame		The frame the wrenches are in
+		 * @param output			The moved wrenches. May be the same matrix as the input
+		 * @return 					'false' if no transform between the frames is cached, 'true' otherwise
+		 */
+		bool transformWrenches(const Matrix6Xd& input, const std::string& target_frame, const std::string& source_frame, Matrix6Xd& output) const;
+
+		/**
+		 * Moves a set of twists, stored one per column, from one frame into another
+		 * @param input				The twists, in the source frame
+		 * @param target_frame		The frame to move the twists into
+		 * @param source_frame		The frame the twists are in
+		 * @param output			The moved twists. May be the same matrix as the input
+		 * @return 					'false' if no transform between the frames is cached, 'true' otherwise
+		 */
+		bool transformTwists(const Matrix6Xd& input, const std::string& target_frame, const std::string& source_frame, Matrix6Xd& output) const;
+
+		/**
+		 * Finds the cached adjoint between two frames. A frame to itself is always found, as the identity
+		 * @param target_frame		The frame to move data into
+		 * @param source_frame		The frame the data is in
+		 * @param inverse			Set to 'true' if the cached transform goes the other way, and must be applied inversely
+		 * @return 					The cached adjoint, or nullptr if there is none
+		 */
+		const AdjointTransform* find(const std::string& target_frame, const std::string& source_frame, bool& inverse) const;
+
+		/**
+		 * Removes every cached transform
+		 */
+		void clear() {pairs_.clear();};
+
+	private:
+		struct FramePair
+		{
+			std::string parent_frame;
+			std::string child_frame;
+			AdjointTransform adjoint;
+		};
+		std::vector<FramePair> pairs_;
+	};
+
+	inline bool FrameTransformer::setTransform(const geometry_msgs::TransformStamped& transform)
+	{
+		for(size_t i=0; i<pairs_.size(); ++i)
+		{
+			if(pairs_[i].parent_frame == transform.header.frame_id && pairs_[i].child_frame == transform.child_frame_id)
+			{
+				return pairs_[i].adjoint.update(transform);
+			}
+			if(pairs_[i].parent_frame == transform.child_frame_id && pairs_[i].child_frame == transform.header.frame_id)
+			{
+				// Keep one entry per pair of frames, in the direction it was first given
+				geometry_msgs::TransformStamped reversed = transform;
+				convert(RigidTransform(transform).inverse().getIsometry(), reversed.transform);
+				return pairs_[i].adjoint.update(reversed);
+			}
+		}
+
+		FramePair pair;
+		pair.parent_frame = transform.header.frame_id;
+		pair.child_frame = transform.child_frame_id;
+		pair.adjoint.update(transform);
+		pairs_.push_back(pair);
+		return true;
+	}
+
+	template <class Buffer>
+	bool FrameTransformer::lookupTransform(const Buffer& buffer, const std::string& target_frame,
+										   const std::string& source_frame, const ros::Time& time)
+	{
+		geometry_msgs::TransformStamped transform;
+		try
+		{
+			transform = buffer.lookupTransform(target_frame, source_frame, time);
+		}
+		catch(const std::exception&)
+		{
+			return false;
+		}
+		setTransform(transform);
+		return true;
+	}
+
+	inline const AdjointTransform* FrameTransformer::find(const std::string& target_frame, const std::string& source_frame, bool& inverse) const
+	{
+		if(target_frame == source_frame)
+		{
+			static const AdjointTransform identity;
+			inverse = false;
+			return &identity;
+		}
+		for(size_t i=0; i<pairs_.size(); ++i)
+		{
+			if(pairs_[i].parent_frame == target_frame && pairs_[i].child_frame == source_frame)
+			{
+				inverse = false;
+				return &pairs_[i].adjoint;
+			}
+			if(pairs_[i].parent_frame == source_frame && pairs_[i].child_frame == target_frame)
+			{
+				inverse = true;
+				return &pairs_[i].adjoint;
+			}
+		}
+		return nullptr;
+	}
+
+	inline bool FrameTransformer::transform(const geometry_msgs::WrenchStamped& input, const std::string& target_frame,
+											geometry_msgs::WrenchStamped& output) const
+	{
+		NRG_PROFILE_SCOPE("FrameTransformer::transform");
+		if(input.header.frame_id == target_frame)
+		{
+			output = input;
+			return true;
+		}
+		bool inverse = false;
+		const AdjointTransform* adjoint = find(target_frame, input.header.frame_id, inverse);
+		if(!adjoint) return false;
+
+		Vector6d wrench;
+		convert(input.wrench, wrench);
+		output.header = input.header;
+		output.header.frame_id = target_frame;
+		return convert(adjoint->transformWrench(wrench, inverse), output.wrench);
+	}
+
+	inline bool FrameTransformer::transform(const geometry_msgs::TwistStamped& input, const std::string& target_frame,
+											geometry_msgs::TwistStamped& output) const
+	{
+		NRG_PROFILE_SCOPE("FrameTransformer::transform");
+		if(input.header.frame_id == target_frame)
+		{
+			output = input;
+			return true;
+		}
+		bool inverse = false;
+		const AdjointTransform* adjoint = find(target_frame, input.header.frame_id, inverse);
+		if(!adjoint) return false;
+
+		Vector6d twist;
+		convert(input.twist, twist);
+		output.header = input.header;
+		output.header.frame_id = target_frame;
+		return convert(adjoint->transformTwist(twist, inverse), output.twist);
+	}
+
+	inline bool FrameTransformer::transformWrenches(const Matrix6Xd& input, const std::string& target_frame,
+													const std::string& source_frame, Matrix6Xd& output) const
+	{
+		NRG_PROFILE_SCOPE("FrameTransformer::transformWrenches");
+		bool inverse = false;
+		const AdjointTransform* adjoint = find(target_frame, source_frame, inverse);
+		if(!adjoint) return false;
+		adjoint->transformWrenches(input, output, inverse);
+		return true;
+	}
+
+	inline bool FrameTransformer::transformTwists(const Matrix6Xd& input, const std::string& target_frame,
+												  const std::string& source_frame, Matrix6Xd& output) const
+	{
+		NRG_PROFILE_SCOPE("FrameTransformer::transformTwists");
+		bool inverse = false;
+		const AdjointTransform* adjoint = find(target_frame, source_frame, inverse);
+		if(!adjoint) return false;
+		adjoint->transformTwists(input, output, inverse);
+		return true;
+	}
+
+} // end nrg_tools namespace
@@ -0,0 +1,177 @@
+// Replays the messages of a bag file through convert, RosLowPassFilter, boundAll and boundUniform
+// as fast as possible, and reports the throughput and latency percentiles of each stage per message type.
+// The bag is read directly (no master needed) and fully loaded before timing, so disk access is not measured.
+// Messages are replayed in bag order, the same number of times, so runs on the same bag are comparable.
+// Every message is timed on its own with the time stamp counter (see profiling.hpp), and the measured cost
+// of reading the counter is subtracted, so the tail percentiles show single slow messages.
+//
+// Usage: bag_benchmark <bag file> [repetitions (default 10)] [cpu to pin to (default none)]
+#include <nrg_tools.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sched.h>
+
+struct StageResult
+{
+	std::string type;
+	std::string stage;
+	size_t messages;
+	double seconds;
+	std::vector<uint64_t> latencies;	// Ticks of each message, less the timer overhead, over all repetitions
+};
+
+// Times call(i) for every message index, once to warm up and then for each repetition
+template<class F> void runStage(const std::string& type, const std::string& stage, const std::vector<size_t>& indices,
+								int repetitions, F call, std::vector<StageResult>& results)
+{
+	if(indices.empty()) return;
+	typedef std::chrono::steady_clock Clock;
+	for(size_t i=0; i<indices.size(); ++i) call(indices[i]);
+
+	StageResult result;
+	result.type = type;
+	result.stage = stage;
+	result.messages = indices.size() * repetitions;
+	result.latencies.resize(result.messages);
+	const uint64_t overhead = nrg_tools::profiling::timerOverheadTicks();
+	size_t n = 0;
+	const Clock::time_point start = Clock::now();
+	for(int repetition=0; repetition<repetitions; ++repetition)
+	{
+		for(size_t i=0; i<indices.size(); ++i, ++n)
+		{
+			const uint64_t before = nrg_tools::profiling::readTicks();
+			call(indices[i]);
+			const uint64_t ticks = nrg_tools::profiling::readTicks() - before;
+			result.latencies[n] = (ticks > overhead) ? ticks - overhead : 0;
+		}
+	}
+	// Includes the timer reads, so the throughput is slightly lower than without timing
+	result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	results.push_back(result);
+}
+
+// Runs every stage over the messages of one type. The filter and bounds only get the messages
+// that convert to the same number of values as the first one (e.g. polygons with the same number of points)
+template<class T> void benchmarkMessages(const std::string& type, const std::vector<T>& messages, int repetitions,
+										 std::vector<StageResult>& results)
+{
+	if(messages.empty()) return;
+	const size_t num_values = nrg_conversions::toVec(messages[0]).size();
+	std::vector<size_t> all, same_size;
+	for(size_t i=0; i<messages.size(); ++i)
+	{
+		all.push_back(i);
+		if(nrg_conversions::toVec(messages[i]).size() == num_values) same_size.push_back(i);
+	}
+	if(same_size.size() < messages.size())
+	{
+		std::printf("%s: %zu of %zu messages differ in size from the first, skipped for the filter and bounds\n",
+					type.c_str(), messages.size() - same_size.size(), messages.size());
+	}
+
+	std::vector<double> values;
+	T output = messages[0];
+	runStage(type, "convert (to and from std::vector)", all, repetitions,
+			 [&](size_t i){nrg_tools::convert(messages[i], values); nrg_tools::convert(values, output);}, results);
+
+	T coefficients = messages[0];
+	nrg_tools::convert(std::vector<double>(num_values, 2.0), coefficients);
+	nrg_tools::RosLowPassFilter<T> filter(coefficients);
+	runStage(type, "RosLowPassFilter::filter", same_size, repetitions, [&](size_t i){output = filter.filter(messages[i]);}, results);
+
+	const std::vector<double> lower(num_values, -1.0), upper(num_values, 1.0);
+	runStage(type, "boundAll", same_size, repetitions, [&](size_t i){output = nrg_tools::boundAll(messages[i], lower, upper);}, results);
+	runStage(type, "boundUniform", same_size, repetitions, [&](size_t i){output = nrg_tools::boundUniform(messages[i], upper);}, results);
+}
+
+// Loads every message of one type from the bag, in bag order, then benchmarks them
+template<class T> void benchmarkType(const rosbag::Bag& bag, int repetitions, std::vector<StageResult>& results)
+{
+	const std::string type = ros::message_traits::DataType<T>::value();
+	rosbag::View view(bag, rosbag::TypeQuery(type));
+	std::vector<T> messages;
+	for(rosbag::View::iterator it = view.begin(); it != view.end(); ++it)
+	{
+		boost::shared_ptr<T> message = it->template instantiate<T>();
+		if(message) messages.push_back(*message);
+	}
+	benchmarkMessages(type, messages, repetitions, results);
+}
+
+// Nearest rank percentile of sorted latencies, in microseconds
+double percentile(const std::vector<uint64_t>& sorted, double fraction)
+{
+	const size_t rank = std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()));
+	return 1e-3 * sorted[rank] / nrg_tools::profiling::ticksPerNanosecond();
+}
+
+int main(int argc, char **argv)
+{
+	if(argc < 2)
+	{
+		std::printf("Usage: %s <bag file> [repetitions (default 10)] [cpu to pin to (default none)]\n", argv[0]);
+		return 1;
+	}
+	const int repetitions = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 10;
+	if(argc > 3)
+	{
+		// Pinning keeps the scheduler from moving the benchmark between cores mid-run
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(std::atoi(argv[3]), &cpus);
+		if(sched_setaffinity(0, sizeof(cpus), &cpus) != 0)
+		{
+			std::printf("Could not pin to cpu %s\n", argv[3]);
+			return 1;
+		}
+	}
+
+	std::printf("Timer overhead: %.1f ns per message, subtracted from the latencies\n",
+				nrg_tools::profiling::timerOverheadTicks() / nrg_tools::profiling::ticksPerNanosecond());
+	ros::Time::init();
+	rosbag::Bag bag;
+	try
+	{
+		bag.open(argv[1], rosbag::bagmode::Read);
+	}
+	catch(const rosbag::BagException& e)
+	{
+		std::printf("Could not open %s: %s\n", argv[1], e.what());
+		return 1;
+	}
+
+	std::vector<StageResult> results;
+	benchmarkType<geometry_msgs::AccelStamped>(bag, repetitions, results);
+	benchmarkType<geometry_msgs::PointStamped>(bag, repetitions, results);
+	benchmarkType<geometry_msgs::PolygonStamped>(bag, repetitions, results);
+	benchmarkType<geometry_msgs::PoseStamped>(bag, repetitions, results);
+	benchmarkType<geometry_msgs::QuaternionStamped>(bag, repetitions, results);
+	benchmarkType<geometry_msgs::TransformStamped>(bag, repetitions, results);
+	benchmarkType<geometry_msgs::TwistStamped>(bag, repetitions, results);
+	benchmarkType<geometry_msgs::Vector3Stamped>(bag, repetitions, results);
+	benchmarkType<geometry_msgs::WrenchStamped>(bag, repetitions, results);
+	benchmarkType<sensor_msgs::JointState>(bag, repetitions, results);
+	bag.close();
+
+	if(results.empty())
+	{
+		std::printf("No messages of a supported type in %s\n", argv[1]);
+		return 1;
+	}
+
+	std::printf("%-30s %-36s %10s %12s %9s %9s %9s %9s %9s\n", "Type", "Stage", "Messages", "Msgs/s", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us");
+	for(size_t i=0; i<results.size(); ++i)
+	{
+		std::vector<uint64_t>& latencies = results[i].latencies;
+		std::sort(latencies.begin(), latencies.end());
+		std::printf("%-30s %-36s %10zu %12.0f %9.2f %9.2f %9.2f %9.2f %9.2f\n", results[i].type.c_str(), results[i].stage.c_str(),
+					results[i].messages, results[i].messages / results[i].seconds, percentile(latencies, 0.5), percentile(latencies, 0.9),
+					percentile(latencies, 0.99), percentile(latencies, 0.999), percentile(latencies, 1.0));
+	}
+	return 0;
+}
@@ -1,4 +1,7 @@
 #include <nrg_tools.h>
+#include <tf2/buffer_core.h>
+#include <algorithm>
+#include <cstdio>
 
 int main(int argc, char **argv)
 {
@@ -89,6 +92,65 @@ int main(int argc, char **argv)
 	std::vector<double> bound_res3 = nrg_tools::boundUniform(bound_test1, bound_limit);
 	std::cout << "\nBounding Test 6: " << nrg_tools::getStr(bound_res3) << ".\n";
 
+	nrg_tools::StampedCache<geometry_msgs::PointStamped> test_cache(4);
+	geometry_msgs::PointStamped cache_point;
+	for(int i=1; i<=5; ++i)
+	{
+		cache_point.header.stamp = ros::Time(i);
+		cache_point.point.x = 10 * i;
+		test_cache.insert(cache_point);
+	}
+	bool cache_found = test_cache.lookup(ros::Time(2.25), cache_point);
+	std::cout << "\nCache Test (" << cache_found << "): " << test_cache.size() << " " << cache_point.point.x << " " << test_cache.lookup(ros::Time(1.5), cache_point) << "\n";
+	cache_point.header.frame_id = "sensor";
+	for(int i=6; i<=7; ++i)
+	{
+		cache_point.header.stamp = ros::Time(i);
+		cache_point.point.x = 10 * i;
+		test_cache.insert(cache_point);
+	}
+	geometry_msgs::PointStamped cached_header;
+	test_cache.lookup(ros::Time(6.5), cached_header);
+	std::cout << "\nCache Header Test: " << cached_header.header.frame_id << " " << cached_header.header.stamp.toSec() << " " << cached_header.point.x << "\n";
+
+	std::vector<geometry_msgs::Pose> waypoints(2), resampled;
+	waypoints[0].orientation.w = 1;
+	waypoints[1].position.x = 4;
+	waypoints[1].orientation.z = 1;
+	nrg_tools::resampleTrajectory(waypoints, {0, 2}, 0.5, resampled, nrg_tools::TrajectoryInterpolator::QUINTIC, {3});
+	std::cout << "\nTrajectory Test: " << resampled.size() << " " << resampled[1].position.x << " " << resampled[2].orientation.z << "\n";
+
+	nrg_tools::ConstraintProjector speed_limit(3, nrg_tools::ConstraintProjector::NEAREST);
+	speed_limit.addBounds(Eigen::Vector3d(1, 1, 1));
+	speed_limit.addNorm(Eigen::MatrixXd::Identity(2, 3), 1.0);
+	geometry_msgs::Vector3 fast_command;
+	fast_command.x = 3;
+	fast_command.z = 0.5;
+	geometry_msgs::Vector3 limited_command = speed_limit.project(fast_command);
+	std::cout << "\nProjection Test: " << limited_command.x << " " << limited_command.z << "\n";
+
+	trajectory_msgs::JointTrajectory joint_trajectory;
+	joint_trajectory.joint_names = {"a", "b"};
+	joint_trajectory.points.resize(3);
+	for(size_t i=0; i<3; ++i)
+	{
+		joint_trajectory.points[i].positions = {1.0 * i, -1.0 * i};
+		joint_trajectory.points[i].velocities = {1, -1};
+		joint_trajectory.points[i].time_from_start = ros::Duration(0.5 * i);
+	}
+	nrg_tools::JointTrajectoryMatrices trajectory_matrices;
+	bool matrices_found = nrg_tools::convert(joint_trajectory, trajectory_matrices);
+	trajectory_matrices.positions *= 2;
+	nrg_tools::convert(trajectory_matrices, joint_trajectory);
+	nrg_tools::JointOrderPlan reversed_joints({"b", "a"});
+	nrg_tools::convert(joint_trajectory, trajectory_matrices, reversed_joints);
+	std::cout << "\nJoint Trajectory Test (" << matrices_found << "): " << trajectory_matrices.positions.cols() << " " << trajectory_matrices.times[2]
+			  << " " << joint_trajectory.points[2].positions[0] << " " << trajectory_matrices.positions(0, 2) << " " << trajectory_matrices.accelerations.size() << "\n";
+	trajectory_msgs::JointTrajectory reordered_trajectory;
+	bool reordered_found = nrg_tools::convert(trajectory_matrices, reordered_trajectory, reversed_joints);
+	std::cout << "\nJoint Trajectory Round Trip Test (" << reordered_found << "): " << reordered_trajectory.joint_names[0] << " "
+			  << reordered_trajectory.points[2].positions[0] << " " << (reordered_trajectory.points[2].positions[0] == joint_trajectory.points[2].positions[1]) << "\n";
+
 
 	std::vector<double> filter_coeffs{2, 2, 2, 2, 2, 2};
 	geometry_msgs::Wrench coeffs;
@@ -101,5 +163,166 @@ int main(int argc, char **argv)
 	filtered_result = test_filter.filter(test4);
 	std::cout << "\nFilter Test 1: " << filtered_result << std::endl;
 
+	const std::string snapshot_path = "/tmp/nrg_tools_conversion_test.snapshot";
+	std::remove(snapshot_path.c_str());
+	nrg_tools::RosLowPassFilter<geometry_msgs::Wrench> restarted_filter(coeffs);
+	bool snapshot_restored;
+	{
+		nrg_tools::FilterSnapshot snapshot(snapshot_path, test_filter.getStateSize());
+		snapshot.save(test_filter);
+	}
+	{
+		nrg_tools::FilterSnapshot snapshot(snapshot_path, restarted_filter.getStateSize());
+		snapshot_restored = snapshot.restore(restarted_filter);
+	}
+	std::remove(snapshot_path.c_str());
+	std::cout << "\nSnapshot Test (" << snapshot_restored << "): " << restarted_filter.filter(test4).force.x << std::endl;
+
+	nrg_tools::RosLowPassFilter<geometry_msgs::Wrench, nrg_tools::fields::Force> force_filter(coeffs);
+	geometry_msgs::Wrench force_result = force_filter.filter(test4);
+	Eigen::Vector3d torque_res;
+	nrg_tools::extractFields<nrg_tools::fields::Torque>(force_result, torque_res);
+	force_result = nrg_tools::boundFields<nrg_tools::fields::Force>(force_result, std::vector<double>{-10, -10, -10}, std::vector<double>{10, 10, 10});
+	std::cout << "\nFields Test: " << force_result.force.x << " " << force_result.force.y << " " << torque_res.transpose() << std::endl;
+
+	nrg_tools::RosDecimatingFilter<geometry_msgs::Wrench> test_decimator(test4, 4);
+	for(int i=0; i<4; ++i)
+	{
+		if(test_decimator.filter(test4, filtered_result)) std::cout << "\nFilter Test 2 (" << i << "): " << filtered_result.force.x << std::endl;
+	}
+
+	nrg_tools::RosMedianFilter<geometry_msgs::Wrench> test_median(test4, 3);
+	test4.force.x = 10000;
+	filtered_result = test_median.filter(test4);
+	std::cout << "\nFilter Test 3: " << filtered_result.force.x << std::endl;
+
+	nrg_tools::BasicMovingStatistics test_stats(3, 6);
+	test4.force.x = 1;
+	test_stats.update(test4);
+	test4.force.x = 3;
+	test_stats.update(test4);
+	std::cout << "\nStatistics Test: " << test_stats.getMean()[0] << " " << test_stats.getVariance()[0] << " " << test_stats.getMin()[0] << " " << test_stats.getMax()[0] << std::endl;
+
+	geometry_msgs::Wrench rate_test = test4;
+	nrg_tools::BasicDifferentiator test_rates(std::vector<double>(6, 0.0), 0.5, nrg_tools::BasicDifferentiator::SAVITZKY_GOLAY, 2.0, 3, 2);
+	rate_test.force.x = 1;
+	test_rates.update(rate_test);
+	rate_test.force.x = 4;
+	test_rates.update(rate_test);
+	std::cout << "\nDifferentiator Test: " << test_rates.getVelocity()[0] << " " << test_rates.getAcceleration()[0] << std::endl;
+
+	geometry_msgs::Wrench kalman_noise;
+	nrg_tools::convert(std::vector<double>(6, 1.0), kalman_noise);
+	nrg_tools::RosKalmanFilter<geometry_msgs::Wrench> test_kalman(rate_test, 1.0, kalman_noise, kalman_noise, true);
+	rate_test.force.x = 10;
+	geometry_msgs::Wrench kalman_res = test_kalman.filter(rate_test), kalman_rate;
+	test_kalman.getDerivative(1, kalman_rate);
+	std::cout << "\nKalman Test: " << kalman_res.force.x << " " << kalman_rate.force.x << std::endl;
+
+	geometry_msgs::Pose test_pose;
+	test_pose.orientation.w = 1;
+	nrg_tools::RosPoseFilter<geometry_msgs::Pose> test_pose_filter(test_pose, 2, 2, nrg_tools::BasicPoseMultiFilter::SLERP);
+	test_pose.orientation.w = -0.7071;
+	test_pose.orientation.z = 0.7071;
+	test_pose = test_pose_filter.filter(test_pose);
+	std::cout << "\nPose Filter Test: " << test_pose.orientation.z << " " << test_pose.orientation.w << std::endl;
+
+	nrg_tools::FusedPipeline<geometry_msgs::Wrench, geometry_msgs::Twist> test_pipeline(test4);
+	test_pipeline.lowPass(filter_coeffs).scale(std::vector<double>(6, 0.01)).boundUniform(std::vector<double>(6, 1.0));
+	geometry_msgs::Twist pipeline_result;
+	test_pipeline.run(test4, pipeline_result);
+	std::cout << "\nPipeline Test: " << pipeline_result.linear.x << std::endl;
+
+	nrg_tools::SpscSampleRing test_ring(6, 2);
+	test_ring.push(nrg_conversions::toVec(test4));
+	test_ring.push(nrg_conversions::toVec(test4));
+	test_ring.push(nrg_conversions::toVec(test4));
+	std::vector<double> ring_batch(12);
+	size_t ring_count = test_ring.drain(ring_batch.data(), 2);
+	std::cout << "\nRing Test: " << ring_count << " " << test_ring.getOverruns() << " " << ring_batch[6] << std::endl;
+
+	Eigen::VectorXd fixed_test = Eigen::VectorXd::Zero(8);
+	nrg_tools::convert(test4, fixed_test.segment<6>(1));
+	Eigen::Vector3f fixed_res;
+	nrg_tools::convert(fixed_test.segment<3>(4), fixed_res);
+	std::cout << "\nFixed Size Test: " << fixed_test[1] << " " << fixed_res.transpose() << std::endl;
+
+	nrg_tools::MonotonicArena arena(1024);
+	geometry_msgs::Polygon arena_polygon;
+	nrg_tools::convert(test2, arena_polygon, nrg_tools::ArenaAllocator<double>(arena));
+	res4 = nrg_tools::boundUniform(res4, std::vector<double>(6, 100.0), nrg_tools::ArenaAllocator<double>(arena));
+	std::cout << "\nArena Test: " << arena_polygon.points[1].x << " " << res4.angular.z << " " << arena.getUsed() << " " << arena.getOverflows() << std::endl;
+	arena.reset();
+
+
+	sensor_msgs::PointCloud2 cloud;
+	nrg_tools::convert(test2, cloud);
+	cloud.data.resize(cloud.data.size() + 12);
+	cloud.width = 4;
+	cloud.row_step = 48;
+	reinterpret_cast<float*>(cloud.data.data())[10] = std::numeric_limits<float>::quiet_NaN();
+	nrg_tools::PointCloudXYZView cloud_view(cloud);
+	Eigen::Matrix3Xd cloud_points;
+	cloud_view.gather(cloud_points, true);
+	std::cout << "\nCloud Test 1 (" << cloud_view.isMappable() << "):\n" << cloud_view.map<float>() << "\n";
+	std::cout << "\nCloud Test 2:\n" << cloud_points << "\n";
+	sensor_msgs::PointCloud2 swapped_cloud = cloud;
+	swapped_cloud.is_bigendian = !cloud.is_bigendian;
+	for(size_t i=0; i+4<=swapped_cloud.data.size(); i+=4) std::reverse(swapped_cloud.data.begin()+i, swapped_cloud.data.begin()+i+4);
+	nrg_tools::PointCloudXYZView swapped_view(swapped_cloud);
+	swapped_view.gather(cloud_points, true);
+	std::cout << "\nCloud Test 3 (" << swapped_view.isMappable() << "):\n" << cloud_points << "\n";
+
+
+	sensor_msgs::JointState joint_state;
+	joint_state.name = {"wrist", "shoulder", "elbow"};
+	joint_state.position = {3, 1, 2};
+	joint_state.velocity = {30, 10, 20};
+	nrg_tools::JointOrderPlan joint_plan({"shoulder", "elbow", "wrist"});
+	Eigen::VectorXd joint_res;
+	bool joint_suc = nrg_tools::convert(joint_state, joint_res, joint_plan);
+	std::cout << "\nJoint Test 1 (" << joint_suc << "): " << joint_res.transpose() << "\n";
+	sensor_msgs::JointState ur_state;
+	ur_state.name = {"wrist_1_joint", "wrist_2_joint", "wrist_3_joint"};
+	ur_state.position = {1, 2, 3};
+	nrg_tools::JointOrderPlan ur_plan(ur_state.name);
+	Eigen::VectorXd ur_res;
+	nrg_tools::convert(ur_state, ur_res, ur_plan);
+	ur_state.name = {"wrist_2_joint", "wrist_1_joint", "wrist_3_joint"};
+	ur_state.position = {2, 1, 3};
+	joint_suc = nrg_tools::convert(ur_state, ur_res, ur_plan);
+	std::cout << "\nJoint Swap Test (" << joint_suc << "): " << ur_res.transpose() << "\n";
+
+
+	geometry_msgs::Transform tran_test;
+	tran_test.translation.x = 1;
+	tran_test.rotation.z = std::sqrt(0.5);
+	tran_test.rotation.w = std::sqrt(0.5);
+	nrg_tools::RigidTransform rigid(tran_test);
+	geometry_msgs::Polygon tran_res1;
+	rigid.apply(test1, tran_res1);
+	Eigen::Matrix3Xd tran_res2 = cloud_points;
+	(rigid.inverse() * rigid).apply(tran_res2, tran_res2);
+	std::cout << "\nTransform Test 1: " << tran_res1.points[0].x << " " << tran_res1.points[0].y << " " << tran_res1.points[0].z << "\n";
+	std::cout << "\nTransform Test 2:\n" << tran_res2 << "\n";
+
+	tf2::BufferCore tf_buffer;
+	geometry_msgs::TransformStamped sensor_transform;
+	sensor_transform.header.frame_id = "tool";
+	sensor_transform.child_frame_id = "sensor";
+	sensor_transform.transform = tran_test;
+	tf_buffer.setTransform(sensor_transform, "conversion_test");
+	nrg_tools::FrameTransformer frames;
+	bool frames_found = frames.lookupTransform(tf_buffer, "tool", "sensor");
+	geometry_msgs::WrenchStamped sensor_wrench, tool_wrench;
+	sensor_wrench.header.frame_id = "sensor";
+	sensor_wrench.wrench.force.x = 10;
+	frames.transform(sensor_wrench, "tool", tool_wrench);
+	std::cout << "\nFrame Test (" << frames_found << "): " << tool_wrench.header.frame_id << " " << tool_wrench.wrench.force.y << " "
+			  << tool_wrench.wrench.torque.z << " " << frames.transform(tool_wrench, "world", sensor_wrench) << "\n";
+	geometry_msgs::WrenchStamped same_wrench;
+	bool same_found = frames.transform(tool_wrench, "tool", same_wrench);
+	std::cout << "\nSame Frame Test (" << same_found << "): " << same_wrench.header.frame_id << " " << same_wrench.wrench.force.y << "\n";
+
 	return 0;
 }
\ No newline at end of file
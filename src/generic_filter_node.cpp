@@ -0,0 +1,83 @@
+/**
+ * Low pass filters any number of topics of any supported message type in one process.
+ * The filtered messages are published on "<input topic>/<output_suffix>".
+ *
+ * Parameters:
+ *   ~topics				List of input topics
+ *   ~filter_coefficient	Coefficient for every element of every topic (default 2.0)
+ *   ~output_suffix			Appended to the input topic name for the output (default "filtered")
+ */
+
+#include <generic_filter.hpp>
+
+class TopicFilter
+{
+public:
+	TopicFilter(ros::NodeHandle& nh, const nrg_tools::GenericFilterRegistry& registry, const std::string& input_topic,
+	            const std::string& output_topic, double filter_coefficient)
+		: nh_(nh), registry_(registry), output_topic_(output_topic), filter_coefficient_(filter_coefficient)
+	{
+		subscriber_ = nh_.subscribe(input_topic, 10, &TopicFilter::callback, this, ros::TransportHints().tcpNoDelay());
+	}
+
+private:
+	ros::NodeHandle nh_;
+	const nrg_tools::GenericFilterRegistry& registry_;
+	std::string output_topic_;
+	double filter_coefficient_;
+	ros::Subscriber subscriber_;
+	std::unique_ptr<nrg_tools::GenericFilterPlan> plan_;
+
+	void callback(const topic_tools::ShapeShifter::ConstPtr& message)
+	{
+		// The type is only looked up once, on the first message
+		if(!plan_)
+		{
+			plan_.reset(registry_.create(*message, filter_coefficient_, nh_, output_topic_));
+			if(!plan_)
+			{
+				ROS_ERROR("Cannot filter %s, type %s is not supported", output_topic_.c_str(), message->getDataType().c_str());
+				subscriber_.shutdown();
+				return;
+			}
+		}
+
+		try
+		{
+			plan_->filter(*message);
+		}
+		catch(const std::exception& e)
+		{
+			ROS_ERROR("Filtering for %s failed: %s", output_topic_.c_str(), e.what());
+		}
+	}
+};
+
+int main(int argc, char **argv)
+{
+	ros::init(argc, argv, "generic_filter");
+	ros::NodeHandle nh;
+	ros::NodeHandle pnh("~");
+
+	std::vector<std::string> topics;
+	pnh.getParam("topics", topics);
+	const double filter_coefficient = pnh.param<double>("filter_coefficient", 2.0);
+	const std::string output_suffix = pnh.param<std::string>("output_suffix", "filtered");
+
+	if(topics.empty())
+	{
+		ROS_ERROR("No topics to filter, set the ~topics parameter");
+		return 1;
+	}
+
+	nrg_tools::GenericFilterRegistry registry;
+	std::vector<std::unique_ptr<TopicFilter> > filters;
+	for(size_t i=0; i<topics.size(); ++i)
+	{
+		const std::string input_topic = nh.resolveName(topics[i]);
+		filters.emplace_back(new TopicFilter(nh, registry, input_topic, input_topic + "/" + output_suffix, filter_coefficient));
+	}
+
+	ros::spin();
+	return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * Nodelet manager that loads a chain of nrg_tools nodelets from the parameter server,
+ * so the whole chain runs in one process and messages are passed without copies.
+ * Stage i subscribes to the output of stage i-1, and publishes on "<stage name>/output".
+ *
+ * Parameters:
+ *   ~stages		List of stage names. Each stage's parameters (including its nodelet "type")
+ *					are read from the "<stage name>" namespace
+ *   ~input			Topic the first stage subscribes to
+ *   ~output		Topic the last stage publishes on
+ *   ~benchmark		If true, also loads a latency probe feeding ~input and reading ~output (default false)
+ *   ~probe_type	Nodelet type of the latency probe (default "nrg_tools/WrenchStampedLatencyProbe")
+ */
+
+#include <ros/ros.h>
+#include <nodelet/loader.h>
+
+int main(int argc, char **argv)
+{
+	ros::init(argc, argv, "pipeline");
+	ros::NodeHandle nh;
+	ros::NodeHandle pnh("~");
+	nodelet::Loader loader;
+
+	std::vector<std::string> stages;
+	pnh.getParam("stages", stages);
+	const std::string input_topic = nh.resolveName(pnh.param<std::string>("input", "input"));
+	const std::string output_topic = nh.resolveName(pnh.param<std::string>("output", "output"));
+	if(stages.empty())
+	{
+		ROS_ERROR("No stages to load, set the ~stages parameter");
+		return 1;
+	}
+
+	const ros::V_string no_args;
+	std::string previous_topic = input_topic;
+	for(size_t i=0; i<stages.size(); ++i)
+	{
+		const std::string name = nh.resolveName(stages[i]);
+		std::string type;
+		if(!ros::param::get(name + "/type", type))
+		{
+			ROS_ERROR("Stage %s has no type parameter", name.c_str());
+			return 1;
+		}
+
+		ros::M_string remappings;
+		remappings["input"] = previous_topic;
+		remappings["output"] = (i+1 == stages.size()) ? output_topic : name + "/output";
+		if(!loader.load(name, type, remappings, no_args))
+		{
+			ROS_ERROR("Failed to load stage %s of type %s", name.c_str(), type.c_str());
+			return 1;
+		}
+		previous_topic = remappings["output"];
+	}
+
+	if(pnh.param<bool>("benchmark", false))
+	{
+		ros::M_string remappings;
+		remappings["probe_output"] = input_topic;
+		remappings["probe_input"] = output_topic;
+		const std::string probe_type = pnh.param<std::string>("probe_type", "nrg_tools/WrenchStampedLatencyProbe");
+		if(!loader.load(pnh.resolveName("latency_probe"), probe_type, remappings, no_args))
+		{
+			ROS_ERROR("Failed to load the latency probe of type %s", probe_type.c_str());
+			return 1;
+		}
+	}
+
+	ros::AsyncSpinner spinner(0);
+	spinner.start();
+	ros::waitForShutdown();
+	return 0;
+}
@@ -0,0 +1,18 @@
+#include <pipeline_nodelets.hpp>
+#include <pluginlib/class_list_macros.h>
+
+namespace nrg_tools{
+	typedef FilterNodelet<geometry_msgs::WrenchStamped> WrenchStampedFilterNodelet;
+	typedef FilterNodelet<geometry_msgs::TwistStamped> TwistStampedFilterNodelet;
+	typedef BoundNodelet<geometry_msgs::WrenchStamped> WrenchStampedBoundNodelet;
+	typedef BoundNodelet<geometry_msgs::TwistStamped> TwistStampedBoundNodelet;
+	typedef LatencyProbeNodelet<geometry_msgs::WrenchStamped> WrenchStampedLatencyProbeNodelet;
+	typedef LatencyProbeNodelet<geometry_msgs::TwistStamped> TwistStampedLatencyProbeNodelet;
+} // end nrg_tools namespace
+
+PLUGINLIB_EXPORT_CLASS(nrg_tools::WrenchStampedFilterNodelet, nodelet::Nodelet)
+PLUGINLIB_EXPORT_CLASS(nrg_tools::TwistStampedFilterNodelet, nodelet::Nodelet)
+PLUGINLIB_EXPORT_CLASS(nrg_tools::WrenchStampedBoundNodelet, nodelet::Nodelet)
+PLUGINLIB_EXPORT_CLASS(nrg_tools::TwistStampedBoundNodelet, nodelet::Nodelet)
+PLUGINLIB_EXPORT_CLASS(nrg_tools::WrenchStampedLatencyProbeNodelet, nodelet::Nodelet)
+PLUGINLIB_EXPORT_CLASS(nrg_tools::TwistStampedLatencyProbeNodelet, nodelet::Nodelet)
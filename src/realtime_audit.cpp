@@ -0,0 +1,472 @@
+// Checks which nrg_tools calls allocate on the heap, for use in realtime loops.
+// Every conversion and filter is run inside a no-allocation scope. Calls expected to be
+// allocation free fail the audit (with a backtrace) if they allocate. Calls that are known to
+// allocate are listed as such, and flagged if they stop allocating so they can be locked in.
+// The numerical tools are also checked against known results, and fail the audit if they drift.
+#define NRG_TOOLS_ENABLE_ALLOCATION_AUDIT
+#define NRG_TOOLS_DEFINE_ALLOCATION_HOOKS
+#include <nrg_tools.h>
+#include <allocation_audit.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+enum Expectation {NO_ALLOCATION, ALLOCATES};
+
+int failures = 0;
+int known = 0;
+int fixed = 0;
+
+// Runs the call once to warm up any lazy initialization, then again under a no-allocation scope
+template<class F> void audit(const char* name, Expectation expectation, F call)
+{
+	call();
+	uint64_t violations;
+	{
+		nrg_tools::allocation_audit::NoAllocationScope scope(name, expectation == NO_ALLOCATION);
+		call();
+		violations = scope.getViolations();
+	}
+
+	if(expectation == NO_ALLOCATION && violations > 0)
+	{
+		std::cout << "FAIL   " << name << ": " << violations << " allocations\n";
+		++failures;
+	}
+	else if(expectation == ALLOCATES && violations == 0)
+	{
+		std::cout << "FIXED  " << name << ": no longer allocates, expect NO_ALLOCATION\n";
+		++fixed;
+	}
+	else if(expectation == ALLOCATES)
+	{
+		std::cout << "KNOWN  " << name << ": " << violations << " allocations\n";
+		++known;
+	}
+	else
+	{
+		std::cout << "OK     " << name << "\n";
+	}
+}
+
+// Compares a result to its known value, element by element
+void check(const char* name, const Eigen::VectorXd& result, const Eigen::VectorXd& expected, double tolerance)
+{
+	const double error = (result.size() == expected.size()) ? (result - expected).cwiseAbs().maxCoeff() : INFINITY;
+	if(error > tolerance)
+	{
+		std::cout << "FAIL   " << name << ": [" << result.transpose() << "] instead of [" << expected.transpose() << "]\n";
+		++failures;
+	}
+	else
+	{
+		std::cout << "OK     " << name << "\n";
+	}
+}
+
+// Converts a type to and from each of the other supported forms, with temporaries from the heap and from an arena.
+// Types of a fixed size convert through the stack, so only the others are expected to use the heap
+template<class T> void auditConversions(const std::string& name, const T& message, Expectation arena_expectation=NO_ALLOCATION)
+{
+	const Expectation expectation = (nrg_conversions::ConvertedSize<T>::value == Eigen::Dynamic) ? ALLOCATES : NO_ALLOCATION;
+	const std::string to_vector = name + " -> std::vector", from_vector = name + " <- std::vector";
+	const std::string to_eigen = name + " -> Eigen::VectorXd", to_self = name + " -> " + name;
+	const std::string to_eigen_arena = to_eigen + " (arena)", to_self_arena = to_self + " (arena)";
+	nrg_tools::MonotonicArena arena(4096);
+	nrg_tools::ArenaAllocator<double> alloc(arena);
+
+	T output = message;
+	std::vector<double> vector_output = nrg_conversions::toVec(message);
+	const std::vector<double> vector_input = vector_output;
+	Eigen::VectorXd eigen_output;
+	nrg_tools::convert(message, eigen_output);
+	audit(to_vector.c_str(), expectation, [&](){nrg_tools::convert(message, vector_output);});
+	audit(from_vector.c_str(), expectation, [&](){nrg_tools::convert(vector_input, output);});
+	audit(to_eigen.c_str(), expectation, [&](){nrg_tools::convert(message, eigen_output);});
+	audit(to_self.c_str(), expectation, [&](){nrg_tools::convert(message, output);});
+	audit(to_eigen_arena.c_str(), arena_expectation, [&](){arena.reset(); nrg_tools::convert(message, eigen_output, alloc);});
+	audit(to_self_arena.c_str(), arena_expectation, [&](){arena.reset(); nrg_tools::convert(message, output, alloc);});
+}
+
+// The steady-state gains of a constant acceleration Kalman filter for one channel, in the textbook matrix form
+Eigen::Vector3d steadyStateGains(double dt, double process_noise, double measurement_noise)
+{
+	Eigen::Matrix3d transition, noise, covariance = Eigen::Matrix3d::Identity();
+	transition << 1, dt, dt*dt/2,
+	              0, 1, dt,
+	              0, 0, 1;
+	noise << std::pow(dt, 5)/20, std::pow(dt, 4)/8, std::pow(dt, 3)/6,
+	         std::pow(dt, 4)/8, std::pow(dt, 3)/3, dt*dt/2,
+	         std::pow(dt, 3)/6, dt*dt/2, dt;
+	Eigen::Vector3d gains = Eigen::Vector3d::Zero(), previous_gains;
+	for(int i=0; i<1000000; ++i)
+	{
+		covariance = transition * covariance * transition.transpose() + process_noise * noise;
+		previous_gains = gains;
+		gains = covariance.col(0) / (covariance(0, 0) + measurement_noise);
+		covariance -= gains * covariance.row(0);
+		if((gains - previous_gains).cwiseAbs().maxCoeff() < 1e-15) break;
+	}
+	return gains;
+}
+
+int main(int argc, char **argv)
+{
+	std::cout << "~~~~~~~~~~ Conversions ~~~~~~~~~~\n";
+	auditConversions("Accel", geometry_msgs::Accel());
+	auditConversions("AccelStamped", geometry_msgs::AccelStamped());
+	auditConversions("Point", geometry_msgs::Point());
+	auditConversions("Point32", geometry_msgs::Point32());
+	auditConversions("PointStamped", geometry_msgs::PointStamped());
+	geometry_msgs::PolygonStamped polygon;
+	polygon.polygon.points.resize(4);
+	auditConversions("Polygon", polygon.polygon);
+	auditConversions("PolygonStamped", polygon);
+	auditConversions("Pose", geometry_msgs::Pose());
+	auditConversions("Pose2D", geometry_msgs::Pose2D());
+	auditConversions("PoseStamped", geometry_msgs::PoseStamped());
+	auditConversions("Quaternion", geometry_msgs::Quaternion());
+	auditConversions("QuaternionStamped", geometry_msgs::QuaternionStamped());
+	auditConversions("Transform", geometry_msgs::Transform());
+	auditConversions("TransformStamped", geometry_msgs::TransformStamped());
+	auditConversions("Twist", geometry_msgs::Twist());
+	auditConversions("TwistStamped", geometry_msgs::TwistStamped());
+	auditConversions("Vector3", geometry_msgs::Vector3());
+	auditConversions("Vector3Stamped", geometry_msgs::Vector3Stamped());
+	auditConversions("Wrench", geometry_msgs::Wrench());
+	auditConversions("WrenchStamped", geometry_msgs::WrenchStamped());
+	auditConversions("tf::Vector3", tf::Vector3(1, 2, 3));
+	auditConversions("tf::Quaternion", tf::Quaternion(0, 0, 0, 1));
+	auditConversions("tf2::Vector3", tf2::Vector3(1, 2, 3));
+	auditConversions("tf2::Quaternion", tf2::Quaternion(0, 0, 0, 1));
+	sensor_msgs::JointState joint_state;
+	joint_state.name = {"a", "b", "c"};
+	joint_state.position = {1, 2, 3};
+	auditConversions("JointState", joint_state);
+	trajectory_msgs::JointTrajectoryPoint trajectory_point;
+	trajectory_point.positions = {1, 2, 3};
+	auditConversions("JointTrajectoryPoint", trajectory_point);
+	sensor_msgs::PointCloud2 cloud;
+	nrg_tools::convert(std::vector<double>(30, 1.0), cloud);
+	auditConversions("PointCloud2", cloud, ALLOCATES);
+	auditConversions("std::vector", std::vector<double>(6, 1.0));
+	auditConversions("Eigen::VectorXd", Eigen::VectorXd::Ones(6).eval());
+	geometry_msgs::Wrench fixed_wrench;
+	geometry_msgs::Point fixed_point;
+	Eigen::Matrix<double, 6, 1> fixed_vector;
+	Eigen::VectorXd dynamic_vector = Eigen::VectorXd::Ones(10);
+	audit("Wrench -> Eigen::Matrix<double, 6, 1>", NO_ALLOCATION, [&](){nrg_tools::convert(fixed_wrench, fixed_vector);});
+	audit("Wrench -> Eigen::VectorXd::segment<6>", NO_ALLOCATION, [&](){nrg_tools::convert(fixed_wrench, dynamic_vector.segment<6>(2));});
+	audit("Eigen::VectorXd::segment<3> -> Point", NO_ALLOCATION, [&](){nrg_tools::convert(dynamic_vector.segment<3>(1), fixed_point);});
+
+	std::cout << "\n~~~~~~~~~~ Filters ~~~~~~~~~~\n";
+	const std::vector<double> ones(6, 1.0), twos(6, 2.0);
+	std::vector<double> vector_output(6);
+	geometry_msgs::Wrench wrench, wrench_output, coefficients;
+	nrg_tools::convert(twos, coefficients);
+
+	nrg_tools::BasicLowPassFilter lowpass(2.0);
+	audit("BasicLowPassFilter::filter", NO_ALLOCATION, [&](){lowpass.filter(1.0);});
+	nrg_tools::BasicLowPassMultiFilter lowpass_multi(twos, ones);
+	audit("BasicLowPassMultiFilter::filter", ALLOCATES, [&](){vector_output = lowpass_multi.filter(ones);});
+	std::vector<double> batch(60, 1.0);
+	audit("BasicLowPassMultiFilter::filterBatch", NO_ALLOCATION, [&](){lowpass_multi.filterBatch(batch.data(), 10);});
+	nrg_tools::RosLowPassFilter<geometry_msgs::Wrench> ros_lowpass(coefficients);
+	audit("RosLowPassFilter::filter", NO_ALLOCATION, [&](){wrench_output = ros_lowpass.filter(wrench);});
+	const std::string snapshot_path = "/tmp/nrg_tools_realtime_audit.snapshot";
+	{
+		nrg_tools::FilterSnapshot snapshot(snapshot_path, ros_lowpass.getStateSize());
+		audit("FilterSnapshot::save", NO_ALLOCATION, [&](){snapshot.save(ros_lowpass);});
+	}
+	std::remove(snapshot_path.c_str());
+	nrg_tools::RosLowPassFilter<geometry_msgs::Wrench, nrg_tools::fields::Force> force_lowpass(coefficients);
+	audit("RosLowPassFilter<Wrench, Force>::filter", NO_ALLOCATION, [&](){wrench_output = force_lowpass.filter(wrench);});
+	Eigen::Vector3d force;
+	audit("extractFields<Force>(Wrench)", NO_ALLOCATION, [&](){nrg_tools::extractFields<nrg_tools::fields::Force>(wrench, force);});
+	audit("writeFields<Force>(Wrench)", NO_ALLOCATION, [&](){nrg_tools::writeFields<nrg_tools::fields::Force>(force, wrench_output);});
+	const Eigen::Vector3d force_lower(-1, -1, -1), force_upper(1, 1, 1);
+	audit("boundFields<Force>", NO_ALLOCATION, [&](){wrench_output = nrg_tools::boundFields<nrg_tools::fields::Force>(wrench, force_lower, force_upper);});
+
+	nrg_tools::BasicMedianMultiFilter median(15, ones, 3.0);
+	audit("BasicMedianMultiFilter::filter", ALLOCATES, [&](){vector_output = median.filter(twos);});
+	nrg_tools::RosMedianFilter<geometry_msgs::Wrench> ros_median(wrench, 15);
+	audit("RosMedianFilter::filter", ALLOCATES, [&](){wrench_output = ros_median.filter(wrench);});
+
+	nrg_tools::BasicDecimatingMultiFilter decimator(4, ones);
+	audit("BasicDecimatingMultiFilter::filter", NO_ALLOCATION, [&](){decimator.filter(twos, vector_output);});
+	nrg_tools::BasicInterpolatingMultiFilter interpolator(4, ones);
+	audit("BasicInterpolatingMultiFilter::push", NO_ALLOCATION, [&](){interpolator.push(twos);});
+	audit("BasicInterpolatingMultiFilter::next", NO_ALLOCATION, [&](){interpolator.next(vector_output);});
+	nrg_tools::RosDecimatingFilter<geometry_msgs::Wrench> ros_decimator(wrench, 4);
+	audit("RosDecimatingFilter::filter", NO_ALLOCATION, [&](){ros_decimator.filter(wrench, wrench_output);});
+	nrg_tools::RosInterpolatingFilter<geometry_msgs::Wrench> ros_interpolator(wrench, 4);
+	audit("RosInterpolatingFilter::next", NO_ALLOCATION, [&](){wrench_output = ros_interpolator.next();});
+
+	geometry_msgs::Pose pose;
+	pose.orientation.w = 1;
+	std::vector<double> pose_vector = nrg_conversions::toVec(pose);
+	nrg_tools::BasicPoseMultiFilter pose_filter(2.0, 2.0, pose_vector);
+	audit("BasicPoseMultiFilter::filter", ALLOCATES, [&](){pose_vector = pose_filter.filter(pose_vector);});
+	nrg_tools::RosPoseFilter<geometry_msgs::Pose> ros_pose_filter(pose, 2.0, 2.0);
+	audit("RosPoseFilter::filter", ALLOCATES, [&](){pose = ros_pose_filter.filter(pose);});
+
+	nrg_tools::BasicMovingStatistics statistics(100, 6);
+	audit("BasicMovingStatistics::update(std::vector)", NO_ALLOCATION, [&](){statistics.update(ones);});
+	audit("BasicMovingStatistics::update(Wrench)", NO_ALLOCATION, [&](){statistics.update(wrench);});
+
+	nrg_tools::BasicDifferentiator differentiator(ones, 0.01);
+	audit("BasicDifferentiator::update(LOW_PASS)", NO_ALLOCATION, [&](){differentiator.update(twos);});
+	nrg_tools::BasicDifferentiator savitzky_golay(ones, 0.01, nrg_tools::BasicDifferentiator::SAVITZKY_GOLAY);
+	audit("BasicDifferentiator::update(SAVITZKY_GOLAY)", NO_ALLOCATION, [&](){savitzky_golay.update(twos);});
+	geometry_msgs::WrenchStamped wrench_stamped;
+	audit("BasicDifferentiator::updateStamped", NO_ALLOCATION, [&](){savitzky_golay.updateStamped(wrench_stamped);});
+
+	nrg_tools::BasicConstantAccelerationFilter kalman(0.01, ones, ones, ones);
+	audit("BasicKalmanMultiFilter::update", NO_ALLOCATION, [&](){kalman.update(twos);});
+	nrg_tools::BasicConstantAccelerationFilter steady_kalman(0.01, ones, ones, ones, true);
+	audit("BasicKalmanMultiFilter::update (steady state)", NO_ALLOCATION, [&](){steady_kalman.update(twos);});
+	audit("BasicKalmanMultiFilter::getState", NO_ALLOCATION, [&](){steady_kalman.getState(1, vector_output);});
+	nrg_tools::RosKalmanFilter<geometry_msgs::Wrench> ros_kalman(wrench, 0.01, coefficients, coefficients);
+	audit("RosKalmanFilter::filter", ALLOCATES, [&](){wrench_output = ros_kalman.filter(wrench);});
+
+	nrg_tools::FusedPipeline<geometry_msgs::Wrench, geometry_msgs::Twist> pipeline(wrench);
+	pipeline.lowPass(twos).scale(ones).bound(ones, twos);
+	geometry_msgs::Twist twist;
+	audit("FusedPipeline::run", NO_ALLOCATION, [&](){pipeline.run(wrench, twist);});
+
+	nrg_tools::SpscSampleRing ring(6, 16);
+	audit("SpscSampleRing::push", NO_ALLOCATION, [&](){ring.push(ones);});
+	audit("SpscSampleRing::drain", NO_ALLOCATION, [&](){ring.drain(batch.data(), 10);});
+
+	std::cout << "\n~~~~~~~~~~ Controller Tools ~~~~~~~~~~\n";
+	audit("boundAll", ALLOCATES, [&](){wrench_output = nrg_tools::boundAll(wrench, ones, twos);});
+	audit("boundUniform", ALLOCATES, [&](){wrench_output = nrg_tools::boundUniform(wrench, twos);});
+	nrg_tools::MonotonicArena arena(4096);
+	nrg_tools::ArenaAllocator<double> alloc(arena);
+	audit("boundAll (arena)", NO_ALLOCATION, [&](){arena.reset(); wrench_output = nrg_tools::boundAll(wrench, ones, twos, alloc);});
+	audit("boundUniform (arena)", NO_ALLOCATION, [&](){arena.reset(); wrench_output = nrg_tools::boundUniform(wrench, twos, alloc);});
+	nrg_tools::ConstraintProjector uniform_projector(7), nearest_projector(7, nrg_tools::ConstraintProjector::NEAREST);
+	const Eigen::MatrixXd jacobian = Eigen::MatrixXd::Random(3, 7);
+	for(nrg_tools::ConstraintProjector* projector : {&uniform_projector, &nearest_projector})
+	{
+		projector->addBounds(Eigen::VectorXd::Ones(7));
+		projector->addNorm(jacobian, 0.5);
+		projector->compile();
+	}
+	Eigen::VectorXd joint_command = 3 * Eigen::VectorXd::Ones(7), limited_command(7);
+	audit("ConstraintProjector::project (uniform)", NO_ALLOCATION, [&](){uniform_projector.project(joint_command, limited_command);});
+	audit("ConstraintProjector::project (nearest)", NO_ALLOCATION, [&](){nearest_projector.project(joint_command, limited_command);});
+	nrg_tools::ConstraintProjector wrench_projector(6);
+	wrench_projector.addBounds(Eigen::VectorXd::Ones(6));
+	audit("ConstraintProjector::project(Wrench)", NO_ALLOCATION, [&](){wrench_output = wrench_projector.project(wrench);});
+
+	Eigen::VectorXd waypoint_times = Eigen::VectorXd::LinSpaced(5, 0, 4), query_times = Eigen::VectorXd::LinSpaced(100, 0, 4);
+	Eigen::MatrixXd trajectory_output, waypoint_matrix = Eigen::MatrixXd::Random(7, 5);
+	nrg_tools::TrajectoryInterpolator trajectory(waypoint_times, waypoint_matrix, nrg_tools::TrajectoryInterpolator::QUINTIC, {3});
+	audit("TrajectoryInterpolator::evaluate", NO_ALLOCATION, [&](){trajectory.evaluate(query_times, trajectory_output);});
+
+	trajectory_msgs::JointTrajectory joint_trajectory;
+	joint_trajectory.joint_names = {"a", "b", "c"};
+	joint_trajectory.points.resize(50);
+	for(size_t i=0; i<joint_trajectory.points.size(); ++i)
+	{
+		joint_trajectory.points[i].positions.assign(3, 0.1 * i);
+		joint_trajectory.points[i].velocities.assign(3, 0.1);
+	}
+	nrg_tools::JointTrajectoryMatrices trajectory_matrices;
+	nrg_tools::convert(joint_trajectory, trajectory_matrices);
+	audit("JointTrajectory -> JointTrajectoryMatrices", NO_ALLOCATION, [&](){nrg_tools::convert(joint_trajectory, trajectory_matrices);});
+	audit("JointTrajectoryMatrices -> JointTrajectory", NO_ALLOCATION, [&](){nrg_tools::convert(trajectory_matrices, joint_trajectory);});
+
+	nrg_tools::StampedCache<geometry_msgs::PoseStamped> pose_cache(16);
+	geometry_msgs::PoseStamped cached_pose;
+	cached_pose.pose.orientation.w = 1;
+	double cache_time = 1;
+	pose_cache.insert(cached_pose);
+	audit("StampedCache::insert", NO_ALLOCATION, [&](){cache_time += 0.1; cached_pose.header.stamp = ros::Time(cache_time); pose_cache.insert(cached_pose);});
+	audit("StampedCache::lookup", NO_ALLOCATION, [&](){pose_cache.lookup(ros::Time(cache_time - 0.05), cached_pose);});
+
+	nrg_tools::JointOrderPlan joint_plan({"c", "a"});
+	joint_plan.update(joint_state.name);
+	Eigen::VectorXd joint_output(2);
+	audit("JointOrderPlan::gather", NO_ALLOCATION, [&](){joint_plan.gather(joint_state.position, joint_output);});
+	audit("JointOrderPlan::update", NO_ALLOCATION, [&](){joint_plan.update(joint_state.name);});
+
+	geometry_msgs::Transform identity;
+	identity.rotation.w = 1;
+	nrg_tools::RigidTransform transform(identity);
+	Eigen::Vector3d point(1, 2, 3);
+	audit("RigidTransform::apply(Vector3d)", NO_ALLOCATION, [&](){point = transform.apply(point);});
+	Eigen::Matrix3Xd points = Eigen::Matrix3Xd::Ones(3, 10), points_output(3, 10);
+	audit("RigidTransform::apply(Matrix3Xd)", NO_ALLOCATION, [&](){transform.apply(points, points_output);});
+
+	nrg_tools::FrameTransformer frames;
+	geometry_msgs::TransformStamped sensor_transform;
+	sensor_transform.header.frame_id = "tool";
+	sensor_transform.child_frame_id = "sensor";
+	sensor_transform.transform = identity;
+	frames.setTransform(sensor_transform);
+	geometry_msgs::WrenchStamped sensor_wrench, tool_wrench;
+	sensor_wrench.header.frame_id = "sensor";
+	frames.transform(sensor_wrench, "tool", tool_wrench);
+	const std::string tool_frame = "tool", sensor_frame = "sensor";
+	nrg_tools::Matrix6Xd wrenches = nrg_tools::Matrix6Xd::Ones(6, 10), wrenches_output(6, 10);
+	audit("FrameTransformer::setTransform", NO_ALLOCATION, [&](){frames.setTransform(sensor_transform);});
+	audit("FrameTransformer::transform(WrenchStamped)", NO_ALLOCATION, [&](){frames.transform(sensor_wrench, "tool", tool_wrench);});
+	audit("FrameTransformer::transformWrenches", NO_ALLOCATION, [&](){frames.transformWrenches(wrenches, tool_frame, sensor_frame, wrenches_output);});
+
+	nrg_tools::PointCloudXYZView cloud_view(cloud);
+	Eigen::Matrix3Xd cloud_points(3, 10);
+	audit("PointCloudXYZView::gather", NO_ALLOCATION, [&](){cloud_view.gather(cloud_points);});
+
+	std::cout << "\n~~~~~~~~~~ Results ~~~~~~~~~~\n";
+	// Closest points with active bounds, worked out by hand from the KKT conditions. A cold start runs the default 20 iterations
+	Eigen::VectorXd projected(3);
+	nrg_tools::ConstraintProjector box_projector(3, nrg_tools::ConstraintProjector::NEAREST);
+	box_projector.addBounds(Eigen::Vector3d(1, 1, 1));
+	box_projector.project(Eigen::Vector3d(3, 0.5, -2), projected);
+	check("ConstraintProjector (bounds)", projected, Eigen::Vector3d(1, 0.5, -1), 1e-3);
+	nrg_tools::ConstraintProjector norm_projector(3, nrg_tools::ConstraintProjector::NEAREST);
+	norm_projector.addBounds(Eigen::Vector3d(1, 1, 1));
+	norm_projector.addNorm(Eigen::MatrixXd::Identity(2, 3), 1.0);
+	norm_projector.project(Eigen::Vector3d(3, 0, 0.5), projected);
+	check("ConstraintProjector (bounds and norm)", projected, Eigen::Vector3d(1, 0, 0.5), 1e-3);
+
+	// x <= 1 and x + y <= 1 are both active, with multipliers 0.5 and 0.5
+	Eigen::VectorXd projected_2d(2);
+	Eigen::MatrixXd sum_row(1, 2);
+	sum_row << 1, 1;
+	nrg_tools::ConstraintProjector linear_projector(2, nrg_tools::ConstraintProjector::NEAREST);
+	linear_projector.addBounds(Eigen::Vector2d(1, 1));
+	linear_projector.addLinear(sum_row, Eigen::VectorXd::Constant(1, -10), Eigen::VectorXd::Ones(1));
+	linear_projector.project(Eigen::Vector2d(2, 0.5), projected_2d);
+	check("ConstraintProjector (bounds and linear)", projected_2d, Eigen::Vector2d(1, 0), 1e-3);
+
+	// Minimizing (x - 2)^2 + 4 (y - 2)^2 with x + y <= 1 gives x = -0.4, y = 1.4. Repeated projections keep converging from the previous one
+	nrg_tools::ConstraintProjector metric_projector(2, nrg_tools::ConstraintProjector::NEAREST);
+	metric_projector.addLinear(sum_row, Eigen::VectorXd::Constant(1, -10), Eigen::VectorXd::Ones(1));
+	metric_projector.setMetric(Eigen::Vector2d(1, 4));
+	metric_projector.project(Eigen::Vector2d(2, 2), projected_2d);
+	check("ConstraintProjector (metric)", projected_2d, Eigen::Vector2d(-0.4, 1.4), 1e-3);
+	for(int i=0; i<5; ++i) metric_projector.project(Eigen::Vector2d(2, 2), projected_2d);
+	check("ConstraintProjector (metric, warm)", projected_2d, Eigen::Vector2d(-0.4, 1.4), 1e-6);
+
+	// 7 joints with bounds, a Cartesian speed limit and coupled rows, where one bound, the norm and both rows are active.
+	// The converged solution satisfies the KKT conditions with positive multipliers (0.87, 1.12, 0.89, 0.11).
+	// A cold start should be within 0.1% of its distance to the input
+	Eigen::MatrixXd speed_rows(3, 7), coupled_rows(2, 7);
+	speed_rows << 0.2, -0.5, 0.1, 0.4, -0.3, 0.6, 0.1,
+	              0.5, 0.3, -0.2, 0.1, 0.4, -0.1, 0.2,
+	              -0.1, 0.2, 0.6, -0.4, 0.1, 0.3, -0.5;
+	coupled_rows << 1, 1, 0, 0, 0, 0, 0,
+	                0, 0, 0, 1, -1, 0, 0;
+	nrg_tools::ConstraintProjector fast_projector(7, nrg_tools::ConstraintProjector::NEAREST);
+	nrg_tools::ConstraintProjector converged_projector(7, nrg_tools::ConstraintProjector::NEAREST, 20000);
+	for(nrg_tools::ConstraintProjector* projector : {&fast_projector, &converged_projector})
+	{
+		projector->addBounds(Eigen::VectorXd::Ones(7));
+		projector->addNorm(speed_rows, 0.5);
+		projector->addLinear(coupled_rows, -1.5 * Eigen::Vector2d::Ones(), 1.5 * Eigen::Vector2d::Ones());
+	}
+	Eigen::VectorXd fast_command(7), converged_command(7), joint_input(7);
+	joint_input << 2, 1.5, -0.5, 1.2, -2, 0.3, 0.8;
+	fast_projector.project(joint_input, fast_command);
+	converged_projector.project(joint_input, converged_command);
+	check("ConstraintProjector (7 joints, converged)", converged_command.tail<4>(), Eigen::Vector4d(0.5, -1, 0.163173, 0.278528), 1e-5);
+	const double converged_distance = (joint_input - converged_command).norm();
+	check("ConstraintProjector (7 joints, 20 iterations)", Eigen::VectorXd::Constant(1, (joint_input - fast_command).norm() / converged_distance),
+		Eigen::VectorXd::Ones(1), 1e-3);
+	const double violation = std::max({fast_command.cwiseAbs().maxCoeff() - 1, (speed_rows * fast_command).norm() - 0.5,
+		(coupled_rows * fast_command).cwiseAbs().maxCoeff() - 1.5, 0.0});
+	check("ConstraintProjector (7 joints, inside the limits)", Eigen::VectorXd::Constant(1, violation), Eigen::VectorXd::Zero(1), 1e-9);
+
+	// Steady-state gains on a noisy sine, against the matrix form applied to the same measurements
+	const double kalman_step = 0.01;
+	nrg_tools::BasicConstantAccelerationFilter steady_reference_kalman(kalman_step, {1.0, 100.0}, {0.01, 1.0}, {0.0, 0.0}, true);
+	Eigen::Vector3d kalman_gains[2] = {steadyStateGains(kalman_step, 1.0, 0.01), steadyStateGains(kalman_step, 100.0, 1.0)};
+	Eigen::Vector3d kalman_state[2] = {Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero()};
+	Eigen::Matrix3d kalman_transition;
+	kalman_transition << 1, kalman_step, kalman_step*kalman_step/2,
+	                     0, 1, kalman_step,
+	                     0, 0, 1;
+	std::vector<double> measurement(2);
+	for(int k=0; k<200; ++k)
+	{
+		measurement[0] = measurement[1] = std::sin(k * kalman_step) + 0.1 * std::sin(37.0 * k);
+		steady_reference_kalman.update(measurement);
+		for(int i=0; i<2; ++i)
+		{
+			kalman_state[i] = kalman_transition * kalman_state[i];
+			kalman_state[i] += kalman_gains[i] * (measurement[i] - kalman_state[i][0]);
+		}
+	}
+	for(int derivative=0; derivative<3; ++derivative)
+	{
+		steady_reference_kalman.getState(derivative, vector_output);
+		const std::string name = "BasicKalmanMultiFilter (steady state, derivative " + std::to_string(derivative) + ")";
+		check(name.c_str(), Eigen::Map<Eigen::VectorXd>(vector_output.data(), 2), Eigen::Vector2d(kalman_state[0][derivative], kalman_state[1][derivative]), 1e-9);
+	}
+
+	// A constant velocity model follows a ramp without lag, and a constant acceleration model a parabola
+	nrg_tools::BasicConstantVelocityFilter ramp_kalman(kalman_step, {1.0}, {0.01}, {2.0});
+	nrg_tools::BasicConstantAccelerationFilter parabola_kalman(kalman_step, {1.0}, {0.01}, {2.0});
+	std::vector<double> velocity(1), acceleration(1);
+	for(int k=1; k<=1000; ++k)
+	{
+		const double t = k * kalman_step;
+		ramp_kalman.update({2 + 3*t});
+		parabola_kalman.update({2 + 3*t + 4*t*t});
+	}
+	ramp_kalman.getState(0, vector_output);
+	ramp_kalman.getState(1, velocity);
+	check("BasicKalmanMultiFilter (ramp)", Eigen::Vector2d(vector_output[0], velocity[0]), Eigen::Vector2d(32, 3), 1e-6);
+	parabola_kalman.getState(0, vector_output);
+	parabola_kalman.getState(1, velocity);
+	parabola_kalman.getState(2, acceleration);
+	check("BasicKalmanMultiFilter (parabola)", Eigen::Vector3d(vector_output[0], velocity[0], acceleration[0]), Eigen::Vector3d(432, 83, 8), 1e-6);
+
+	// A quadratic fit is exact on a parabola once the window is full
+	nrg_tools::BasicDifferentiator parabola_savitzky_golay({2.0}, kalman_step, nrg_tools::BasicDifferentiator::SAVITZKY_GOLAY);
+	for(int k=1; k<=20; ++k)
+	{
+		const double t = k * kalman_step;
+		parabola_savitzky_golay.update({2 + 3*t + 4*t*t});
+	}
+	check("BasicDifferentiator (SAVITZKY_GOLAY)", Eigen::Vector2d(parabola_savitzky_golay.getVelocity()[0], parabola_savitzky_golay.getAcceleration()[0]),
+		Eigen::Vector2d(3 + 8*0.2, 8), 1e-6);
+
+	// Sliding medians of an odd and an even window against sorting each window. Even windows average the middle two
+	for(int window_size : {5, 4})
+	{
+		nrg_tools::BasicMedianMultiFilter window_median(window_size, {0.0});
+		std::vector<double> history(window_size, 0.0), sorted;
+		double error = 0;
+		for(int k=0; k<100; ++k)
+		{
+			const double value = std::sin(1.7 * k) + 0.01 * k;
+			history.erase(history.begin());
+			history.push_back(value);
+			sorted = history;
+			std::sort(sorted.begin(), sorted.end());
+			const double expected = 0.5 * (sorted[(window_size - 1) / 2] + sorted[window_size / 2]);
+			error = std::max(error, std::abs(window_median.filter({value})[0] - expected));
+		}
+		const std::string name = "BasicMedianMultiFilter (window " + std::to_string(window_size) + ")";
+		check(name.c_str(), Eigen::VectorXd::Constant(1, error), Eigen::VectorXd::Zero(1), 0.0);
+	}
+
+	// Once the window has some spread, a Hampel filter replaces a spike by the median (1.0),
+	// and passes the measurements after it through unchanged
+	nrg_tools::BasicMedianMultiFilter hampel(5, {1.0}, 3.0);
+	const double hampel_input[8] = {1.1, 0.9, 1.05, 0.95, 1.0, 50.0, 1.02, 0.98};
+	Eigen::VectorXd hampel_output(3);
+	for(int k=0; k<8; ++k)
+	{
+		const double value = hampel.filter({hampel_input[k]})[0];
+		if(k >= 5) hampel_output[k-5] = value;
+	}
+	check("BasicMedianMultiFilter (Hampel)", hampel_output, Eigen::Vector3d(1.0, 1.02, 0.98), 0.0);
+
+	std::cout << "\n" << failures << " failed, " << known << " known to allocate, " << fixed << " no longer allocate\n";
+	return (failures > 0 || fixed > 0) ? 1 : 0;
+}